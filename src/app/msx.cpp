@@ -1,12 +1,31 @@
 ﻿#include <iostream>
 #include <chrono>
 #include <string>
+#include <fstream>
+#include <random>
 #include "core/game.h"
 #include "benchmarks/bench.h"
+#include "benchmarks/batch.h"
+#include "benchmarks/harvest.h"
+#include "benchmarks/compare.h"
+#include "benchmarks/generate.h"
+#include "server/daemon.h"
 #include "core/solver.h"
+#include "games/replay.h"
+#include "utils/session.h"
+#include "utils/trace.h"
 
 namespace {
-    constexpr std::string_view HELP_MESSAGE = "Minesweeper Solver X [Version 1.0.0]\nUsage: msx [-hvd] {google,veasy,vmedium,vhard,vimpossible} | msx -b[v]";
+    constexpr std::string_view HELP_MESSAGE = "Minesweeper Solver X [Version 1.0.0]\nUsage: msx [-hvd] {google,veasy,vmedium,vhard,vimpossible} | msx -b[v]"
+        " | msx --batch N --size WxH --mines M [--threads T] [--interleave G] [--seed S] [--out FILE] | msx --batch N --seeds FILE"
+        " | msx --sweep MAX_SIZE [--attempts N] [--time-cap SECONDS]"
+        " | msx --generate N --size WxH --mines M --out FILE [--threads T] [--seed S]"
+        " | msx --harvest N --size WxH --mines M --out FILE [--seed S]"
+        " | msx --compare A,B --size WxH --mines M [--attempts MAX] [--threads T] [--seed S]"
+        " | msx --serve {SOCKET,-} [--threads T] | msx --client SOCKET | msx --replay FILE [--speed {max,recorded}]"
+        "\nGames, -b, --sweep and --batch accept --strategy NAME (--strategy list shows the registered strategies)"
+        "\nGames accept --record FILE to save every screenshot and mouse input for --replay"
+        "\nAny mode accepts --trace FILE to write a Chrome trace when built with -DMSX_TRACE=ON";
     
     struct ProgramOptions {
 		bool benchmark = false;
@@ -14,17 +33,136 @@ namespace {
 		bool print_board = false;
         std::chrono::milliseconds delay_override{};
 		std::string game_type;
+        BatchOptions batch;
+        std::string output_path;
+        int attempts = DEFAULT_ATTEMPTS;
+        bool sweep = false;
+        SweepOptions sweep_options;
+        uint64_t harvest = 0;
+        uint64_t generate = 0;
+        std::string seeds_path;
+        bool compare = false;
+        CompareOptions compare_options;
+        std::string serve_path;
+        std::string client_path;
+        std::string trace_path;
+        std::string record_path;
+        std::string replay_path;
+        bool recorded_speed = false;
+        std::string strategy = DEFAULT_STRATEGY_NAME;
     };
 
+    void parse_size(const std::string& size, int& width, int& height) {
+        size_t separator = size.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Size must be formatted as WxH: " + size);
+        }
+        width = std::stoi(size.substr(0, separator));
+        height = std::stoi(size.substr(separator + 1));
+    }
+
     ProgramOptions arg_parse(int argc, char* argv[]) {
         ProgramOptions options;
-
+        options.batch.seed = std::random_device{}();
 
         for (int i = 1; i < argc; i++) {
             std::string_view arg = std::string_view(argv[i]);
             if (arg.empty()) continue; 
 
-            if (arg[0] == '-') {
+            if (arg.rfind("--", 0) == 0) {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Missing value for " + std::string(arg));
+                }
+                std::string value = argv[++i];
+                if (arg == "--batch") {
+                    options.batch.games = std::stoull(value);
+                }
+                else if (arg == "--size") {
+                    parse_size(value, options.batch.width, options.batch.height);
+                }
+                else if (arg == "--mines") {
+                    options.batch.mines = std::stoi(value);
+                }
+                else if (arg == "--threads") {
+                    options.batch.threads = static_cast<unsigned int>(std::stoul(value));
+                }
+                else if (arg == "--interleave") {
+                    options.batch.interleave = static_cast<unsigned int>(std::stoul(value));
+                }
+                else if (arg == "--seed") {
+                    options.batch.seed = static_cast<unsigned int>(std::stoul(value));
+                }
+                else if (arg == "--out") {
+                    options.output_path = value;
+                }
+                else if (arg == "--sweep") {
+                    options.sweep = true;
+                    options.sweep_options.max_size = std::stoi(value);
+                }
+                else if (arg == "--compare") {
+                    size_t separator = value.find(',');
+                    if (separator == std::string::npos) {
+                        throw std::runtime_error("Compare needs two strategies formatted as A,B: " + value);
+                    }
+                    options.compare = true;
+                    options.compare_options.baseline = value.substr(0, separator);
+                    options.compare_options.candidate = value.substr(separator + 1);
+                }
+                else if (arg == "--generate") {
+                    options.generate = std::stoull(value);
+                }
+                else if (arg == "--seeds") {
+                    options.seeds_path = value;
+                }
+                else if (arg == "--harvest") {
+                    options.harvest = std::stoull(value);
+                }
+                else if (arg == "--serve") {
+                    options.serve_path = value;
+                }
+                else if (arg == "--client") {
+                    options.client_path = value;
+                }
+                else if (arg == "--strategy") {
+                    if (value == "list") {
+                        for (const Strategy* strategy : registered_strategies()) {
+                            std::cout << strategy->name << ": " << strategy->description << std::endl;
+                        }
+                        std::exit(0);
+                    }
+                    find_strategy(value);
+                    options.strategy = value;
+                }
+                else if (arg == "--trace") {
+                    if (!trace::ENABLED) {
+                        throw std::runtime_error("Tracing is not compiled in, configure with -DMSX_TRACE=ON");
+                    }
+                    options.trace_path = value;
+                }
+                else if (arg == "--record") {
+                    options.record_path = value;
+                }
+                else if (arg == "--replay") {
+                    options.replay_path = value;
+                }
+                else if (arg == "--speed") {
+                    if (value != "max" && value != "recorded") {
+                        throw std::runtime_error("Speed must be max or recorded: " + value);
+                    }
+                    options.recorded_speed = value == "recorded";
+                }
+                else if (arg == "--attempts") {
+                    options.attempts = std::stoi(value);
+                    options.sweep_options.attempts = options.attempts;
+                }
+                else if (arg == "--time-cap") {
+                    options.sweep_options.time_cap = std::chrono::seconds(std::stoi(value));
+                }
+                else {
+                    throw std::runtime_error("Unknown argument " + std::string(arg));
+                }
+            }
+            else if (arg[0] == '-') {
                 for (size_t j = 1; j < arg.length(); j++) {
                     switch (arg[j]) {
                         case 'b':
@@ -53,25 +191,133 @@ namespace {
 			}
         }
 
-        if (options.game_type.empty() && !options.benchmark) {
+        if (options.attempts <= 0) {
+            throw std::runtime_error("Attempts must be positive");
+        }
+        if (options.game_type.empty() && !options.benchmark && !options.sweep && !options.compare && options.batch.games == 0 && options.harvest == 0
+            && options.generate == 0 && options.serve_path.empty() && options.client_path.empty()
+            && options.replay_path.empty()) {
             throw std::runtime_error("Game type must be specified");
         }
 
         return options;
     }
-}
-
 
+    // Plays a recorded session through board recognition and the solver, then compares and times every stage
+    void run_replay(const ProgramOptions& options) {
+        std::shared_ptr<Replay> replay = Replay::open(options.replay_path, options.recorded_speed);
+        Solver<Replay, UNPACED> solver = Solver<Replay, UNPACED>(replay, options.verbose);
+        solver.set_strategy(find_strategy(options.strategy));
+        try {
+            const SolverResult result = solver.solve();
+            std::cout << "Replay finished: " << (result == SUCCESS ? "won" : result == FAILURE ? "lost" : "stuck") << std::endl;
+        }
+        catch (const session::SessionEnded&) {
+            std::cout << "Replay ran out of frames before the game ended" << std::endl;
+        }
+        replay->print_report(solver.get_stats());
+        if (!replay->decisions_match()) {
+            throw std::runtime_error("Replay diverged from the recorded session");
+        }
+    }
 
-int main(int argc, char* argv[]) {
-    try {
-        ProgramOptions options = arg_parse(argc, argv);
+    void run(const ProgramOptions& options) {
         if (options.benchmark) {
-			Benchmark::full_benchmark(options.verbose);
-			return 0;
+			Benchmark::full_benchmark(options.verbose, options.attempts, options.strategy);
+			return;
+        }
+        if (options.sweep) {
+            SweepOptions sweep = options.sweep_options;
+            sweep.strategy = options.strategy;
+            Benchmark::sweep(sweep);
+            return;
+        }
+        if (options.compare) {
+            CompareOptions compare = options.compare_options;
+            compare.width = options.batch.width;
+            compare.height = options.batch.height;
+            compare.mines = options.batch.mines;
+            compare.threads = options.batch.threads;
+            compare.seed = options.batch.seed;
+            compare.max_games = options.attempts;
+            StrategyComparison comparison = StrategyComparison(compare);
+            StrategyComparison::print_result(compare, comparison.run());
+            return;
+        }
+        if (!options.serve_path.empty()) {
+            ServerOptions server_options;
+            server_options.socket_path = options.serve_path;
+            server_options.threads = options.batch.threads;
+            AnalysisServer server = AnalysisServer(server_options);
+            server.run();
+            return;
+        }
+        if (!options.client_path.empty()) {
+            run_client(options.client_path);
+            return;
+        }
+        if (options.generate > 0) {
+            if (options.output_path.empty()) {
+                throw std::runtime_error("Generating needs an output file (--out)");
+            }
+            GenerateOptions generate;
+            generate.boards = options.generate;
+            generate.width = options.batch.width;
+            generate.height = options.batch.height;
+            generate.mines = options.batch.mines;
+            generate.threads = options.batch.threads;
+            generate.seed = options.batch.seed;
+            generate_boards(generate, options.output_path);
+            return;
+        }
+        if (options.harvest > 0) {
+            if (options.output_path.empty()) {
+                throw std::runtime_error("Harvesting needs an output file (--out)");
+            }
+            HarvestOptions harvest;
+            harvest.positions = options.harvest;
+            harvest.width = options.batch.width;
+            harvest.height = options.batch.height;
+            harvest.mines = options.batch.mines;
+            harvest.seed = options.batch.seed;
+            harvest_positions(harvest, options.output_path);
+            return;
+        }
+        if (options.batch.games > 0) {
+            BatchOptions batch = options.batch;
+            batch.strategy = options.strategy;
+            if (!options.seeds_path.empty()) {
+                // Saved no-guess boards carry their own size
+                SeedFile seeds = read_seed_file(options.seeds_path);
+                batch.width = seeds.width;
+                batch.height = seeds.height;
+                batch.mines = seeds.mines;
+                batch.seeds = seeds.seeds;
+                batch.no_guess = true;
+            }
+            BatchRunner runner = BatchRunner(batch);
+            if (options.output_path.empty()) {
+                runner.run(std::cout);
+            }
+            else {
+                std::ofstream out(options.output_path);
+                if (!out) {
+                    throw std::runtime_error("Could not open output file: " + options.output_path);
+                }
+                runner.run(out);
+            }
+            return;
         }
 
-        // Get correct game
+        if (!options.replay_path.empty()) {
+            run_replay(options);
+            return;
+        }
+
+        // Get correct game, recording from the first screenshot that looks for it
+        if (!options.record_path.empty()) {
+            session::start_recording(options.record_path);
+        }
         std::shared_ptr<Game> game = Game::get_game(options.game_type, options.delay_override);
         if (!game) {
             throw std::runtime_error("Invalid game type: " + options.game_type);
@@ -80,6 +326,7 @@ int main(int argc, char* argv[]) {
         // Execute solver
         std::cout << "Starting Minesweeper Solver X for game type " << options.game_type << std::endl;
         Solver solver = Solver(game, options.verbose);
+        solver.set_strategy(find_strategy(options.strategy));
         SolverResult result = solver.solve();
 
         // Ending message
@@ -94,6 +341,23 @@ int main(int argc, char* argv[]) {
                 std::cout << "I'm stuck..." << std::endl;
                 break;
             }
+        if (!options.record_path.empty()) {
+            session::stop_recording();
+            std::cout << "Session written to " << options.record_path << std::endl;
+        }
+    }
+}
+
+
+
+int main(int argc, char* argv[]) {
+    try {
+        ProgramOptions options = arg_parse(argc, argv);
+        run(options);
+        if (!options.trace_path.empty()) {
+            trace::write_chrome_trace(options.trace_path);
+            std::cout << "Trace written to " << options.trace_path << std::endl;
+        }
         return 0;
     }
     catch (const std::exception& e) {
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/scheduler.h"
+#include "core/solver.h"
+#include "games/virtual.h"
+
+#include "batch.h"
+
+static const char* result_name(SolverResult result) {
+	switch (result) {
+	case SUCCESS:
+		return "won";
+	case FAILURE:
+		return "lost";
+	default:
+		return "stuck";
+	}
+}
+
+BatchRunner::BatchRunner(const BatchOptions& o) : options(o) {
+	if (options.games == 0 || options.width <= 0 || options.height <= 0) {
+		throw std::runtime_error("Batch mode needs a game count and a board size");
+	}
+	if (options.mines <= 0 || options.mines > options.width * options.height - 9) {
+		throw std::runtime_error("Invalid mine count for a " + std::to_string(options.width) + "x" + std::to_string(options.height) + " board");
+	}
+	if (!options.seeds.empty() && options.games > options.seeds.size()) {
+		throw std::runtime_error("Batch mode has only " + std::to_string(options.seeds.size()) + " seeds for " + std::to_string(options.games) + " games");
+	}
+	if (options.threads == 0) {
+		options.threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+void BatchRunner::run(std::ostream& out) {
+	std::atomic<uint64_t> next_game{ 0 };
+	std::atomic<uint64_t> wins{ 0 };
+	std::mutex out_mutex;
+	const Strategy& strategy = find_strategy(options.strategy);
+
+	auto seed_of = [&](uint64_t i) {
+		return options.seeds.empty() ? options.seed + static_cast<unsigned int>(i) : options.seeds[i];
+	};
+	auto make_game = [&](unsigned int seed) {
+		auto game = std::make_shared<Virtual>(options.width, options.height, options.mines, std::chrono::milliseconds(0), seed);
+		game->set_no_guess(options.no_guess);
+		return game;
+	};
+
+	auto write_record = [&](std::ostringstream& record, uint64_t i, unsigned int seed, const Virtual& game, SolverResult result,
+		const SolverStats& stats, std::chrono::microseconds wall_time, std::chrono::microseconds cpu_time) {
+		const double completion = static_cast<double>(game.get_board()->discovered_count()) / (options.width * options.height);
+		if (result == SUCCESS) {
+			wins++;
+		}
+
+		record.str("");
+		record << "{\"game\":" << i
+			<< ",\"seed\":" << seed
+			<< ",\"width\":" << options.width
+			<< ",\"height\":" << options.height
+			<< ",\"mines\":" << options.mines
+			<< ",\"result\":\"" << result_name(result) << "\""
+			<< ",\"moves\":" << stats.moves
+			<< ",\"guesses\":" << stats.guesses
+			<< ",\"propagated\":" << stats.propagated
+			<< ",\"inputs\":" << stats.inputs
+			<< ",\"wall_us\":" << wall_time.count()
+			<< ",\"cpu_us\":" << cpu_time.count()
+			<< ",\"completion\":" << completion
+			<< "}\n";
+
+		// Records are written as games finish, so nothing accumulates in memory
+		std::lock_guard<std::mutex> lock(out_mutex);
+		out << record.str() << std::flush;
+	};
+
+	auto worker = [&]() {
+		std::ostringstream record;
+		record << std::fixed << std::setprecision(4);
+		for (uint64_t i = next_game++; i < options.games; i = next_game++) {
+			const unsigned int seed = seed_of(i);
+			const auto wall_start = std::chrono::steady_clock::now();
+			const auto cpu_start = thread_cpu_time();
+
+			auto game = make_game(seed);
+			Solver<Virtual, UNPACED> solver = Solver<Virtual, UNPACED>(game, false);
+			solver.set_strategy(strategy);
+			SolverResult result = solver.solve();
+
+			const auto cpu_time = std::chrono::duration_cast<std::chrono::microseconds>(thread_cpu_time() - cpu_start);
+			const auto wall_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wall_start);
+			write_record(record, i, seed, *game, result, solver.get_stats(), wall_time, cpu_time);
+		}
+	};
+
+	// Keeps options.interleave games in flight on one thread, cpu_us is the thread CPU time of a game's own steps
+	struct Job {
+		std::shared_ptr<Virtual> game;
+		Solver<Virtual, UNPACED> solver;
+		std::chrono::steady_clock::time_point start;
+	};
+	auto interleaved_worker = [&]() {
+		std::ostringstream record;
+		record << std::fixed << std::setprecision(4);
+		CoroutineScheduler scheduler;
+		std::function<void()> start_next = [&]() {
+			const uint64_t i = next_game++;
+			if (i >= options.games) {
+				return;
+			}
+			const unsigned int seed = seed_of(i);
+			auto game = make_game(seed);
+			auto job = std::make_shared<Job>(Job{ game, Solver<Virtual, UNPACED>(game, false), std::chrono::steady_clock::now() });
+			job->solver.set_strategy(strategy);
+			scheduler.spawn(job->solver.solve_async(), [&, i, seed, job](SolverResult result, std::chrono::nanoseconds run_time) {
+				const auto wall_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - job->start);
+				write_record(record, i, seed, *job->game, result, job->solver.get_stats(), wall_time,
+					std::chrono::duration_cast<std::chrono::microseconds>(run_time));
+				start_next();
+			});
+		};
+		for (unsigned int slot = 0; slot < options.interleave; slot++) {
+			start_next();
+		}
+		scheduler.run();
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	// A failing game (e.g. a no-guess board that cannot be generated) stops the batch and is rethrown here
+	std::exception_ptr failure;
+	std::mutex failure_mutex;
+	auto guarded = [&](const std::function<void()>& body) {
+		try {
+			body();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(failure_mutex);
+			if (!failure) {
+				failure = std::current_exception();
+			}
+			next_game = options.games;
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned int t = 0; t < options.threads; t++) {
+		if (options.interleave > 0) {
+			pool.emplace_back(guarded, interleaved_worker);
+		}
+		else {
+			pool.emplace_back(guarded, worker);
+		}
+	}
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+	const double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Summary goes to stderr so the record stream stays pure NDJSON
+	std::cerr << "Played " << options.games << " games on " << options.threads << " threads"
+		<< (options.interleave > 0 ? " (" + std::to_string(options.interleave) + " interleaved per thread)" : "") << " in "
+		<< std::fixed << std::setprecision(2) << elapsed_seconds << " seconds ("
+		<< static_cast<double>(wins) / options.games * 100 << "% won, "
+		<< options.games / elapsed_seconds << " games per second)" << std::endl;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core/strategy.h"
+
+struct BatchOptions {
+	uint64_t games = 0;
+	int width = 0;
+	int height = 0;
+	int mines = 0;
+	unsigned int threads = 0; // 0 uses every hardware thread
+	unsigned int seed = 0;    // Seed of the first game, game i uses seed + i
+	std::string strategy = DEFAULT_STRATEGY_NAME;
+	std::vector<unsigned int> seeds; // Replaces seed + i when set, game i uses seeds[i]
+	bool no_guess = false;           // Generate boards that never need a guess
+	unsigned int interleave = 0;     // Games each thread plays at once as coroutines, 0 plays them one after another
+};
+
+// Plays many virtual games on a thread pool, streaming one NDJSON record per finished game
+class BatchRunner {
+public:
+	BatchRunner(const BatchOptions& o);
+	void run(std::ostream& out);
+
+private:
+	BatchOptions options;
+};
@@ -1,44 +1,263 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <random>
+#include <thread>
+#include "core/scheduler.h"
 #include "core/solver.h"
 #include "core/board.h"
+#include "core/work_pool.h"
 #include "games/virtual.h"
 
 #include "bench.h"
 
-static const int ATTEMPTS = 2500;
-
-Benchmark::Benchmark(int w, int h, int m, bool v) : width(w), height(h), mines(m), verbose(v) {}
-
-void Benchmark::full_benchmark(bool verbose) {
-	std::cout << "Minesweeper Solver X Algortihm Benchmark:" << std::endl;
-	
-	std::cout << "Easy board (10x8 m=10)" << std::endl;
-	Benchmark bench = Benchmark(10, 8, 10, verbose);
-	bench.run();
-	bench.print_results();
-	
-	std::cout << "Medium board (18x14 m=40)" << std::endl;
-	Benchmark bench2 = Benchmark(18, 14, 40, verbose);
-	bench2.run();
-	bench2.print_results();
-	
-	std::cout << "Hard board (24x20 m=99)" << std::endl;
-	Benchmark bench3 = Benchmark(24, 20, 99, verbose);
-	bench3.run();
-	bench3.print_results();
+Benchmark::Benchmark(int w, int h, int m, bool v, int a, std::chrono::seconds tc) : width(w), height(h), mines(m),
+	attempts(a), time_cap(tc), seed(std::random_device{}()), strategy(&find_strategy(DEFAULT_STRATEGY_NAME)), verbose(v) {}
+
+// Board sizes covered by the full benchmark
+struct BoardConfig {
+	const char* name;
+	int width;
+	int height;
+	int mines;
+};
+
+static const BoardConfig STANDARD_BOARDS[] = {
+	{ "Easy", 10, 8, 10 },
+	{ "Medium", 18, 14, 40 },
+	{ "Hard", 24, 20, 99 }
+};
+
+// Most blocking threads the paced interleaving comparison starts
+static const unsigned int MAX_BLOCKING_THREADS = 64;
+
+void Benchmark::full_benchmark(bool verbose, int attempts, const std::string& strategy) {
+	std::cout << "Minesweeper Solver X Algortihm Benchmark (" << strategy << " strategy):" << std::endl;
+
+	for (const BoardConfig& config : STANDARD_BOARDS) {
+		std::cout << config.name << " board (" << config.width << "x" << config.height << " m=" << config.mines << ")" << std::endl;
+		Benchmark bench = Benchmark(config.width, config.height, config.mines, verbose, attempts);
+		bench.set_strategy(strategy);
+		bench.run();
+		bench.print_results();
+
+		// Replay the same games on the generic board to compare against the fixed-size specialisation
+		Benchmark generic = Benchmark(config.width, config.height, config.mines, verbose, attempts);
+		generic.set_seed(bench.get_seed());
+		generic.set_specialised(false);
+		generic.set_strategy(strategy);
+		generic.run();
+		double fixed_seconds = bench.total_time().count() / bench.games_played();
+		double generic_seconds = generic.total_time().count() / generic.games_played();
+		std::cout << "Generic Board: " << std::fixed << std::setprecision(5) << generic_seconds << " seconds per attempt ("
+			<< std::setprecision(2) << generic_seconds / fixed_seconds << "x fixed board speedup)" << std::endl;
+	}
+
+	parallel_scaling(std::max(1, attempts / 100));
+	interleaving(std::max(10, attempts / 10));
+}
+
+// Boards large enough for the frontier to split into many independent components
+static const BoardConfig PARALLEL_BOARDS[] = {
+	{ "Huge", 100, 100, 1500 },
+	{ "Giant", 200, 200, 6000 }
+};
+
+void Benchmark::parallel_scaling(int attempts) {
+	const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned int> thread_counts;
+	for (unsigned int threads = 1; threads < hardware; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(hardware);
+
+	std::cout << "Parallel Component Analysis (" << attempts << " attempts per point):" << std::endl;
+	for (const BoardConfig& config : PARALLEL_BOARDS) {
+		Benchmark sequential = Benchmark(config.width, config.height, config.mines, false, attempts);
+		sequential.run();
+		const double sequential_ms = sequential.total_time().count() * 1000.0 / sequential.games_played();
+		std::cout << config.name << " board (" << config.width << "x" << config.height << " m=" << config.mines << "): "
+			<< std::fixed << std::setprecision(2) << sequential_ms << " ms per attempt sequential" << std::endl;
+
+		// Same boards on the work-stealing pool at each core count
+		for (unsigned int threads : thread_counts) {
+			WorkStealingPool::set_shared_threads(threads);
+			Benchmark parallel = Benchmark(config.width, config.height, config.mines, false, attempts);
+			parallel.set_seed(sequential.get_seed());
+			parallel.set_strategy("parallel");
+			parallel.run();
+			const double parallel_ms = parallel.total_time().count() * 1000.0 / parallel.games_played();
+			std::cout << std::setw(4) << threads << (threads == 1 ? " core:  " : " cores: ") << std::fixed << std::setprecision(2)
+				<< parallel_ms << " ms per attempt (" << sequential_ms / parallel_ms << "x speedup)" << std::endl;
+		}
+	}
+	WorkStealingPool::set_shared_threads(hardware);
+}
+
+// Plays every game at once on one thread, returns games per second
+template<Pacing P>
+static double play_interleaved(const BoardConfig& config, unsigned int seed, int games, std::chrono::milliseconds delay) {
+	std::vector<Solver<Virtual, P>> solvers;
+	solvers.reserve(games); // Tasks refer to their solver, so it must not move
+	CoroutineScheduler scheduler;
+	for (int i = 0; i < games; i++) {
+		solvers.emplace_back(std::make_shared<Virtual>(config.width, config.height, config.mines, delay, seed + i), false);
+		scheduler.spawn(solvers.back().solve_async(), [](SolverResult, std::chrono::nanoseconds) {});
+	}
+	const auto start = std::chrono::steady_clock::now();
+	scheduler.run();
+	return games / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Plays the games on a fixed number of blocking threads, returns games per second
+template<Pacing P>
+static double play_threaded(const BoardConfig& config, unsigned int seed, int games, std::chrono::milliseconds delay, unsigned int threads) {
+	std::atomic<int> next_game{ 0 };
+	auto worker = [&]() {
+		for (int i = next_game++; i < games; i = next_game++) {
+			auto game = std::make_shared<Virtual>(config.width, config.height, config.mines, delay, seed + i);
+			Solver<Virtual, P>(game, false).solve();
+		}
+	};
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (unsigned int t = 0; t < threads; t++) {
+		pool.emplace_back(worker);
+	}
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+	return games / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The same boards played by blocking solvers and by coroutine solvers sharing one thread
+void Benchmark::interleaving(int games) {
+	const BoardConfig& config = STANDARD_BOARDS[2];
+	const unsigned int seed = std::random_device{}();
+	std::cout << "Interleaved Solving (" << games << " games, " << config.width << "x" << config.height << " m=" << config.mines << "):" << std::endl;
+
+	const double sequential = play_threaded<UNPACED>(config, seed, games, std::chrono::milliseconds(0), 1);
+	const double interleaved = play_interleaved<UNPACED>(config, seed, games, std::chrono::milliseconds(0));
+	std::cout << "Without move delay: " << std::fixed << std::setprecision(1) << sequential << " games/s on one blocking thread, "
+		<< interleaved << " games/s interleaved on one thread" << std::endl;
+
+	// With a move delay the waits overlap instead of holding a thread per game. The blocking side gets a thread per
+	// game up to a bound, past that the OS would spend more on the threads than on the games
+	const std::chrono::milliseconds delay(1);
+	const unsigned int blocking_threads = std::min(static_cast<unsigned int>(games), MAX_BLOCKING_THREADS);
+	const double threaded = play_threaded<PACED>(config, seed, games, delay, blocking_threads);
+	const double paced = play_interleaved<PACED>(config, seed, games, delay);
+	std::cout << "With " << delay.count() << " ms move delay: " << std::fixed << std::setprecision(1) << threaded
+		<< " games/s on " << blocking_threads << " blocking threads, " << paced << " games/s interleaved on one thread" << std::endl;
+}
+
+void Benchmark::sweep(const SweepOptions& options) {
+	const int densities[] = { 5, 10, 15, 20, 25 };
+	std::vector<int> sizes;
+	for (int size : { 10, 20, 50, 100, 200, 500, 1000 }) {
+		if (size <= options.max_size) {
+			sizes.push_back(size);
+		}
+	}
+
+	std::cout << "Minesweeper Solver X Scaling Sweep (" << options.strategy << " strategy, " << options.attempts << " attempts, "
+		<< options.time_cap.count() << "s cap per point):" << std::endl;
+	std::cout << std::setw(11) << "Board" << std::setw(9) << "Density" << std::setw(9) << "Mines"
+		<< std::setw(7) << "Games" << std::setw(8) << "Win%" << std::setw(13) << "ms/game"
+		<< std::setw(13) << "us/cell" << std::setw(8) << "Slope" << std::endl;
+
+	for (int density : densities) {
+		double previous_cells = 0.0;
+		double previous_time = 0.0;
+		for (int size : sizes) {
+			const int mines = size * size * density / 100;
+			Benchmark bench = Benchmark(size, size, mines, false, options.attempts, options.time_cap);
+			bench.set_strategy(options.strategy);
+			bench.run();
+
+			const double ms_per_game = bench.total_time().count() * 1000.0 / bench.games_played();
+			const double revealed = bench.revealed_cells();
+			const double us_per_cell = revealed > 0 ? bench.total_time().count() * 1e6 / revealed : 0.0;
+
+			// Local exponent of time per game against cell count, 1.0 means linear scaling
+			const double cells = static_cast<double>(size) * size;
+			std::ostringstream slope;
+			if (previous_cells > 0) {
+				slope << std::fixed << std::setprecision(2) << std::log(ms_per_game / previous_time) / std::log(cells / previous_cells);
+			}
+			else {
+				slope << "-";
+			}
+			previous_cells = cells;
+			previous_time = ms_per_game;
+
+			std::cout << std::setw(11) << (std::to_string(size) + "x" + std::to_string(size))
+				<< std::setw(8) << density << "%" << std::setw(9) << mines
+				<< std::setw(7) << bench.games_played()
+				<< std::fixed << std::setprecision(2) << std::setw(8) << bench.win_rate() * 100
+				<< std::setprecision(3) << std::setw(13) << ms_per_game
+				<< std::setw(13) << us_per_cell
+				<< std::setw(8) << slope.str() << std::endl;
+		}
+	}
 }
 
+double Benchmark::win_rate() const {
+	return run_times.empty() ? 0.0 : static_cast<double>(successes) / run_times.size();
+}
+
+std::chrono::duration<double> Benchmark::total_time() const {
+	std::chrono::microseconds elapsed_time = std::chrono::microseconds(0);
+	for (std::chrono::microseconds time : run_times) {
+		elapsed_time += time;
+	}
+	return elapsed_time;
+}
+
+double Benchmark::revealed_cells() const {
+	double total_completion = 0.0;
+	for (double p : percent_completion) {
+		total_completion += p;
+	}
+	return total_completion * width * height;
+}
 
 void Benchmark::run() {
 	std::shared_ptr<Virtual> game;
-	for (int i = 0; i < ATTEMPTS; i++) {
+	const auto run_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < attempts; i++) {
+		if (time_cap.count() > 0 && i > 0 && std::chrono::steady_clock::now() - run_start >= time_cap) {
+			break;
+		}
+
 		auto start = std::chrono::high_resolution_clock::now();
-		game = std::make_shared<Virtual>(width, height, mines);
-		Solver solver = Solver(game, verbose);
+		alloc_tracker::reset_thread_stats();
+		game = std::make_shared<Virtual>(width, height, mines, std::chrono::milliseconds(0), seed + i, specialised);
+		Solver<Virtual, UNPACED> solver = Solver<Virtual, UNPACED>(game, verbose);
+		solver.set_strategy(*strategy);
 		SolverResult result = solver.solve();
+		SolverStats stats = solver.get_stats();
+		cache_hits += stats.cache_hits;
+		cache_misses += stats.cache_misses;
+		moves += stats.moves;
+		inputs += stats.inputs;
+		if (stage_stats.empty()) {
+			stage_stats = stats.stages;
+		}
+		else {
+			for (size_t s = 0; s < stage_stats.size(); s++) {
+				stage_stats[s].calls += stats.stages[s].calls;
+				stage_stats[s].hits += stats.stages[s].hits;
+				stage_stats[s].time += stats.stages[s].time;
+			}
+		}
 
 		// Store run time
 		auto end = std::chrono::high_resolution_clock::now();
+		alloc_tracker::merge(memory, alloc_tracker::thread_stats());
 		std::chrono::microseconds duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 		run_times.push_back(duration);
 
@@ -63,24 +282,17 @@ void Benchmark::run() {
 }
 
 void Benchmark::print_results() {
-	double success_rate = static_cast<double>(successes) / ATTEMPTS * 100;
-	double failure_rate = static_cast<double>(failures) / ATTEMPTS * 100;
-	double timeout_rate = static_cast<double>(timeouts) / ATTEMPTS * 100;
+	const int played = games_played();
+	double success_rate = static_cast<double>(successes) / played * 100;
+	double failure_rate = static_cast<double>(failures) / played * 100;
+	double timeout_rate = static_cast<double>(timeouts) / played * 100;
 
 	// Calculate total and average completion time
-	std::chrono::microseconds elapsed_time = std::chrono::microseconds(0);
-	for (std::chrono::microseconds time : run_times) {
-		elapsed_time += time;
-	}
-    double elapsed_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed_time).count();
-	double per_attempt_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed_time / ATTEMPTS).count();
+    double elapsed_seconds = total_time().count();
+	double per_attempt_seconds = elapsed_seconds / played;
 
 	// Calculate average completion percentage
-	double total_completion = 0.0;
-	for (double p : percent_completion) {
-		total_completion += p;
-	}
-	double average_completion = (total_completion / ATTEMPTS) * 100.0;
+	double average_completion = revealed_cells() / (width * height) / played * 100.0;
 
 	// Print results
 	std::cout << "Wins: " << successes << " (" << std::fixed << std::setprecision(2) << success_rate << "%)" << std::endl;
@@ -89,4 +301,27 @@ void Benchmark::print_results() {
 	std::cout << "Average Completion: " << std::fixed << std::setprecision(2) << average_completion << "%" << std::endl;
 	std::cout << "Elapsed Time: " << std::fixed << std::setprecision(2) << elapsed_seconds << " seconds ("
 		<< std::fixed << std::setprecision(5) << per_attempt_seconds << " seconds per attempt)" << std::endl;
+	std::cout << "Input Events: " << std::fixed << std::setprecision(1) << static_cast<double>(inputs) / played << " per game for "
+		<< static_cast<double>(moves) / played << " moves" << std::endl;
+	double cache_hit_rate = cache_hits + cache_misses > 0 ? static_cast<double>(cache_hits) / (cache_hits + cache_misses) * 100 : 0.0;
+	std::cout << "Component Cache: " << cache_hits << " hits, " << cache_misses << " misses ("
+		<< std::fixed << std::setprecision(2) << cache_hit_rate << "% hit rate)" << std::endl;
+	if constexpr (alloc_tracker::ENABLED) {
+		for (size_t p = 0; p < memory.size(); p++) {
+			if (memory[p].allocations == 0) {
+				continue;
+			}
+			std::cout << "Memory " << alloc_tracker::phase_name(static_cast<alloc_tracker::Phase>(p)) << ": "
+				<< std::fixed << std::setprecision(1) << static_cast<double>(memory[p].allocations) / played << " allocations, "
+				<< static_cast<double>(memory[p].bytes) / played / 1024 << " KB per attempt, "
+				<< static_cast<double>(memory[p].peak_live) / 1024 << " KB peak live" << std::endl;
+		}
+	}
+	std::cout << "Peak RSS: " << std::fixed << std::setprecision(1) << alloc_tracker::peak_rss_bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+	for (const StageStats& stage : stage_stats) {
+		double hit_rate = stage.calls > 0 ? static_cast<double>(stage.hits) / stage.calls * 100 : 0.0;
+		std::cout << "Stage " << stage.name << ": " << stage.calls << " calls, " << stage.hits << " hits ("
+			<< std::fixed << std::setprecision(2) << hit_rate << "%), "
+			<< std::chrono::duration<double, std::milli>(stage.time).count() << " ms" << std::endl;
+	}
 }
\ No newline at end of file
@@ -1,23 +1,64 @@
 #pragma once
 #include <chrono>
+#include <string>
+#include <vector>
+#include "core/strategy.h"
+#include "utils/alloc_tracker.h"
+
+constexpr int DEFAULT_ATTEMPTS = 2500;
+
+struct SweepOptions {
+	int attempts = 100;                                // Games per point
+	std::chrono::seconds time_cap = std::chrono::seconds(10); // Stop starting new games at a point after this long
+	int max_size = 1000;                               // Largest board side length
+	std::string strategy = DEFAULT_STRATEGY_NAME;
+};
 
 class Benchmark {
 public:
-	Benchmark(int w, int h, int m, bool v);
+	Benchmark(int w, int h, int m, bool v, int a = DEFAULT_ATTEMPTS, std::chrono::seconds tc = std::chrono::seconds(0));
 	void run();
 	void print_results();
-	static void full_benchmark(bool verbose);
+	static void full_benchmark(bool verbose, int attempts = DEFAULT_ATTEMPTS, const std::string& strategy = DEFAULT_STRATEGY_NAME);
+	static void sweep(const SweepOptions& options);
+	static void parallel_scaling(int attempts);
+	static void interleaving(int games);
+
+	// Game i of a run uses seed + i, so two runs with the same seed play the same boards
+	void set_seed(unsigned int s) { seed = s; }
+	unsigned int get_seed() const { return seed; }
+	void set_specialised(bool s) { specialised = s; }
+	void set_strategy(const std::string& name) { strategy = &find_strategy(name); }
+
+	// Summaries of the last run
+	int games_played() const { return static_cast<int>(run_times.size()); }
+	double win_rate() const;
+	std::chrono::duration<double> total_time() const;
+	double revealed_cells() const;
 private:
 	// Board config
 	int width;
 	int height;
 	int mines;
 
+	// Run config
+	int attempts;
+	std::chrono::seconds time_cap; // Zero for no cap
+	unsigned int seed;
+	bool specialised = true; // Use fixed-size boards where available
+	const Strategy* strategy;
+
 	// Results
 	int successes = 0;
 	int failures = 0;
 	int timeouts = 0;
+	size_t cache_hits = 0;
+	size_t cache_misses = 0;
+	long long moves = 0;
+	long long inputs = 0; // Clicks, flags and chords actually sent, fewer than moves when chords replace clicks
+	std::vector<StageStats> stage_stats; // Summed over every game
+	alloc_tracker::Stats memory{};       // Allocations and bytes summed over every game, peak is the largest of any game
 	bool verbose;
 	std::vector<std::chrono::microseconds> run_times;
 	std::vector<double> percent_completion;
-};
\ No newline at end of file
+};
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "core/scheduler.h"
+#include "games/virtual.h"
+#include "batch.h"
+
+#include "compare.h"
+
+StrategyComparison::StrategyComparison(const CompareOptions& o) : options(o),
+	baseline(&find_strategy(o.baseline)), candidate(&find_strategy(o.candidate)) {
+	if (options.width <= 0 || options.height <= 0) {
+		throw std::runtime_error("Comparison needs a board size");
+	}
+	if (options.mines <= 0 || options.mines > options.width * options.height - 9) {
+		throw std::runtime_error("Invalid mine count for a " + std::to_string(options.width) + "x" + std::to_string(options.height) + " board");
+	}
+	if (options.max_games <= 0 || options.round_games <= 0 || options.resamples <= 0) {
+		throw std::runtime_error("Comparison needs positive game and resample counts");
+	}
+	if (options.threads == 0) {
+		options.threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// One check after every round from min_games on, the last round may be short
+	planned_checks = 0;
+	for (int played = 0; played < options.max_games;) {
+		played = std::min(played + options.round_games, options.max_games);
+		planned_checks += played >= options.min_games || played == options.max_games;
+	}
+	check_confidence = 1.0 - (1.0 - options.confidence) / planned_checks;
+}
+
+void StrategyComparison::play_round(int count) {
+	const size_t first = games.size();
+	games.resize(first + count);
+	std::atomic<int> next{ 0 };
+
+	auto play = [&](unsigned int seed, const Strategy& strategy, bool& won, int64_t& cpu_us) {
+		const auto cpu_start = thread_cpu_time();
+		auto game = std::make_shared<Virtual>(options.width, options.height, options.mines, std::chrono::milliseconds(0), seed);
+		Solver<Virtual, UNPACED> solver = Solver<Virtual, UNPACED>(game, false);
+		solver.set_strategy(strategy);
+		won = solver.solve() == SUCCESS;
+		cpu_us = std::chrono::duration_cast<std::chrono::microseconds>(thread_cpu_time() - cpu_start).count();
+	};
+
+	auto worker = [&]() {
+		for (int i = next++; i < count; i = next++) {
+			const size_t index = first + i;
+			const unsigned int seed = options.seed + static_cast<unsigned int>(index);
+			PairedGame& paired = games[index];
+
+			// Alternate which strategy goes first so neither one always runs on a warm cache
+			if (index % 2 == 0) {
+				play(seed, *baseline, paired.won_a, paired.cpu_us_a);
+				play(seed, *candidate, paired.won_b, paired.cpu_us_b);
+			}
+			else {
+				play(seed, *candidate, paired.won_b, paired.cpu_us_b);
+				play(seed, *baseline, paired.won_a, paired.cpu_us_a);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned int t = 0; t < options.threads; t++) {
+		pool.emplace_back(worker);
+	}
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+}
+
+// Percentile bootstrap over boards, resampling the pairs together so board difficulty cancels out
+CompareResult StrategyComparison::summarise(uint64_t resample_seed) const {
+	CompareResult result;
+	const int n = static_cast<int>(games.size());
+	result.games = n;
+	result.interval_confidence = check_confidence;
+	result.planned_checks = planned_checks;
+
+	std::mt19937_64 generator(resample_seed);
+	std::uniform_int_distribution<int> pick(0, n - 1);
+	auto resample = [&](double& win_delta, double& time_delta) {
+		int64_t wins_a = 0, wins_b = 0;
+		double cpu_a = 0.0, cpu_b = 0.0;
+		for (int i = 0; i < n; i++) {
+			const PairedGame& game = games[pick(generator)];
+			wins_a += game.won_a;
+			wins_b += game.won_b;
+			cpu_a += static_cast<double>(game.cpu_us_a);
+			cpu_b += static_cast<double>(game.cpu_us_b);
+		}
+		win_delta = static_cast<double>(wins_b - wins_a) / n * 100.0;
+		time_delta = cpu_a > 0.0 ? (cpu_b / cpu_a - 1.0) * 100.0 : 0.0;
+	};
+
+	int64_t wins_a = 0, wins_b = 0;
+	double cpu_a = 0.0, cpu_b = 0.0;
+	for (const PairedGame& game : games) {
+		wins_a += game.won_a;
+		wins_b += game.won_b;
+		cpu_a += static_cast<double>(game.cpu_us_a);
+		cpu_b += static_cast<double>(game.cpu_us_b);
+	}
+	result.win_rate_a = static_cast<double>(wins_a) / n * 100.0;
+	result.win_rate_b = static_cast<double>(wins_b) / n * 100.0;
+	result.mean_cpu_us_a = cpu_a / n;
+	result.mean_cpu_us_b = cpu_b / n;
+	result.win_delta.estimate = result.win_rate_b - result.win_rate_a;
+	result.time_delta.estimate = cpu_a > 0.0 ? (cpu_b / cpu_a - 1.0) * 100.0 : 0.0;
+
+	std::vector<double> win_samples(options.resamples);
+	std::vector<double> time_samples(options.resamples);
+	for (int r = 0; r < options.resamples; r++) {
+		resample(win_samples[r], time_samples[r]);
+	}
+
+	auto interval = [&](std::vector<double>& samples, DeltaInterval& delta) {
+		std::sort(samples.begin(), samples.end());
+		const double tail = (1.0 - check_confidence) / 2.0;
+		const size_t last = samples.size() - 1;
+		delta.low = samples[static_cast<size_t>(tail * last)];
+		delta.high = samples[static_cast<size_t>((1.0 - tail) * last + 0.5)];
+	};
+	interval(win_samples, result.win_delta);
+	interval(time_samples, result.time_delta);
+	return result;
+}
+
+CompareResult StrategyComparison::run(bool print_progress) {
+	games.clear();
+	games.reserve(options.max_games);
+
+	if (print_progress) {
+		std::cout << "Comparing " << options.baseline << " (A) against " << options.candidate
+			<< " (B) on " << options.width << "x" << options.height << " with " << options.mines << " mines, seed " << options.seed << std::endl;
+		std::cout << std::setw(7) << "games" << std::setw(9) << "win A" << std::setw(9) << "win B"
+			<< std::setw(30) << "win delta (pp)" << std::setw(30) << "cpu time delta (%)" << std::endl;
+	}
+
+	CompareResult result;
+	while (static_cast<int>(games.size()) < options.max_games) {
+		play_round(std::min(options.round_games, options.max_games - static_cast<int>(games.size())));
+		result = summarise(options.seed);
+
+		if (print_progress) {
+			auto format = [](const DeltaInterval& delta) {
+				std::ostringstream text;
+				text << std::showpos << std::fixed << std::setprecision(2) << delta.estimate
+					<< " [" << delta.low << ", " << delta.high << "]" << (delta.significant() ? " *" : "  ");
+				return text.str();
+			};
+			std::cout << std::fixed << std::setprecision(2) << std::setw(7) << result.games
+				<< std::setw(9) << result.win_rate_a << std::setw(9) << result.win_rate_b
+				<< std::setw(30) << format(result.win_delta) << std::setw(30) << format(result.time_delta) << std::endl;
+		}
+
+		if (result.games >= options.min_games && result.win_delta.significant()) {
+			result.stopped_early = result.games < options.max_games;
+			break;
+		}
+	}
+	return result;
+}
+
+void StrategyComparison::print_result(const CompareOptions& options, const CompareResult& result) {
+	std::ostringstream level;
+	level << std::fixed << std::setprecision(2) << result.interval_confidence * 100.0;
+	const std::string interval_name = level.str() + "% CI ";
+	auto format = [&](const DeltaInterval& delta, const char* unit) {
+		std::ostringstream text;
+		text << std::showpos << std::fixed << std::setprecision(2) << delta.estimate << unit << ", " << interval_name
+			<< delta.low << " to " << delta.high;
+		return text.str();
+	};
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< (result.stopped_early ? "Stopped early after " : "Finished after ") << result.games << " paired games" << std::endl
+		<< "Win rate: " << result.win_rate_a << "% -> " << result.win_rate_b << "% (" << format(result.win_delta, " pp") << ")" << std::endl
+		<< "CPU time per game: " << result.mean_cpu_us_a / 1000.0 << " ms -> " << result.mean_cpu_us_b / 1000.0 << " ms ("
+		<< format(result.time_delta, "%") << ")" << std::endl
+		<< std::setprecision(0) << options.confidence * 100.0 << "% confidence across " << result.planned_checks
+		<< " significance checks, stopping on the win rate only" << std::endl;
+}
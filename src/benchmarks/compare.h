@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/solver.h"
+
+struct CompareOptions {
+	std::string baseline = DEFAULT_STRATEGY_NAME;  // Registered strategy A
+	std::string candidate = DEFAULT_STRATEGY_NAME; // Registered strategy B
+	int width = 0;
+	int height = 0;
+	int mines = 0;
+	int max_games = 2500;       // Boards played by each strategy at most
+	int min_games = 200;        // Boards played before the first significance check
+	int round_games = 100;      // Boards played between significance checks
+	unsigned int threads = 0;   // 0 uses every hardware thread
+	unsigned int seed = 0;      // Seed of the first board, board i uses seed + i
+	double confidence = 0.95;   // Across all significance checks, each check uses a Bonferroni share of the error
+	int resamples = 5000;       // Bootstrap resamples per interval, enough for the tails of the adjusted level
+};
+
+// Bootstrap interval of a paired difference, B minus A
+struct DeltaInterval {
+	double estimate = 0.0;
+	double low = 0.0;
+	double high = 0.0;
+	bool significant() const { return low > 0.0 || high < 0.0; }
+};
+
+struct CompareResult {
+	int games = 0;
+	double win_rate_a = 0.0;
+	double win_rate_b = 0.0;
+	double mean_cpu_us_a = 0.0;
+	double mean_cpu_us_b = 0.0;
+	DeltaInterval win_delta;  // Percentage points
+	DeltaInterval time_delta; // Relative change in total CPU time, in percent
+	double interval_confidence = 0.0; // Level of both intervals after the adjustment for repeated checks
+	int planned_checks = 0;
+	bool stopped_early = false;
+};
+
+// Plays two strategies on the same seeded boards and reports paired win rate and time deltas.
+// Rounds of games are played on a thread pool until the win rate interval excludes zero or max_games is reached.
+// Win rate is the primary metric, the CPU time interval is only reported.
+class StrategyComparison {
+public:
+	StrategyComparison(const CompareOptions& o);
+	CompareResult run(bool print_progress = true);
+	static void print_result(const CompareOptions& options, const CompareResult& result);
+
+private:
+	struct PairedGame {
+		bool won_a;
+		bool won_b;
+		int64_t cpu_us_a;
+		int64_t cpu_us_b;
+	};
+
+	CompareOptions options;
+	const Strategy* baseline;
+	const Strategy* candidate;
+	std::vector<PairedGame> games;
+	int planned_checks;
+	double check_confidence;
+
+	void play_round(int count);
+	CompareResult summarise(uint64_t resample_seed) const;
+};
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include "core/board.h"
+#include "games/no_guess.h"
+
+#include "generate.h"
+
+void generate_boards(const GenerateOptions& options, const std::string& path) {
+	if (options.boards == 0 || options.width <= 0 || options.height <= 0) {
+		throw std::runtime_error("Board generation needs a board count and a board size");
+	}
+	if (options.mines <= 0 || options.mines > options.width * options.height - 9) {
+		throw std::runtime_error("Invalid mine count for a " + std::to_string(options.width) + "x" + std::to_string(options.height) + " board");
+	}
+	const unsigned int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+	SeedFile file{ options.width, options.height, options.mines, {} };
+	std::atomic<uint64_t> next_seed{ 0 };
+	std::atomic<uint64_t> found{ 0 };
+	std::atomic<uint64_t> repairs{ 0 };
+	std::atomic<uint64_t> restarts{ 0 };
+	std::mutex seeds_mutex;
+
+	auto worker = [&]() {
+		// Neighbour tables come from the board, each thread keeps its own
+		std::shared_ptr<Board> board = make_board(options.width, options.height);
+		const int start_index = board->to_index(options.width / 2, options.height / 2);
+		std::vector<bool> layout;
+		std::vector<unsigned int> local_seeds;
+		NoGuessStats stats;
+		while (found < options.boards) {
+			const unsigned int seed = options.seed + static_cast<unsigned int>(next_seed++);
+			std::mt19937 generator(seed);
+			if (generate_no_guess(*board, options.mines, start_index, generator, layout, &stats)) {
+				local_seeds.push_back(seed);
+				found++;
+			}
+		}
+		repairs += stats.repairs;
+		restarts += stats.restarts;
+		std::lock_guard<std::mutex> lock(seeds_mutex);
+		file.seeds.insert(file.seeds.end(), local_seeds.begin(), local_seeds.end());
+	};
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (unsigned int t = 0; t < threads; t++) {
+		pool.emplace_back(worker);
+	}
+	for (std::thread& thread : pool) {
+		thread.join();
+	}
+	const double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Threads can overshoot, keep the lowest seeds so the output does not depend on scheduling
+	std::sort(file.seeds.begin(), file.seeds.end());
+	file.seeds.resize(options.boards);
+	write_seed_file(file, path);
+
+	std::cerr << "Generated " << found << " no-guess boards from " << next_seed << " seeds on " << threads << " threads in "
+		<< std::fixed << std::setprecision(2) << elapsed_seconds << " seconds (" << found / elapsed_seconds << " boards per second, "
+		<< static_cast<double>(repairs) / next_seed << " repairs and " << static_cast<double>(restarts) / next_seed << " restarts per board)" << std::endl;
+}
+
+void write_seed_file(const SeedFile& file, const std::string& path) {
+	std::ofstream out(path);
+	if (!out) {
+		throw std::runtime_error("Could not open output file: " + path);
+	}
+	out << "msx-seeds " << file.width << " " << file.height << " " << file.mines << "\n";
+	for (unsigned int seed : file.seeds) {
+		out << seed << "\n";
+	}
+}
+
+SeedFile read_seed_file(const std::string& path) {
+	std::ifstream in(path);
+	if (!in) {
+		throw std::runtime_error("Could not open seed file: " + path);
+	}
+
+	SeedFile file;
+	std::string magic;
+	if (!(in >> magic >> file.width >> file.height >> file.mines) || magic != "msx-seeds") {
+		throw std::runtime_error("Not a seed file: " + path);
+	}
+	unsigned int seed;
+	while (in >> seed) {
+		file.seeds.push_back(seed);
+	}
+	if (!in.eof()) {
+		throw std::runtime_error("Invalid seed in " + path);
+	}
+	return file;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GenerateOptions {
+	uint64_t boards = 0;
+	int width = 0;
+	int height = 0;
+	int mines = 0;
+	unsigned int threads = 0; // 0 uses every hardware thread
+	unsigned int seed = 0;    // First seed tried, the following seeds are tried in order
+};
+
+// Seeds of no-guess boards, all played from the middle tile like first_move
+struct SeedFile {
+	int width = 0;
+	int height = 0;
+	int mines = 0;
+	std::vector<unsigned int> seeds;
+};
+
+// Searches seeds whose Virtual no-guess layout was generated without giving up and writes the first options.boards
+// of them to path. Throughput is printed to stderr.
+void generate_boards(const GenerateOptions& options, const std::string& path);
+
+// Text format: a "msx-seeds WIDTH HEIGHT MINES" header line, then one seed per line
+void write_seed_file(const SeedFile& file, const std::string& path);
+SeedFile read_seed_file(const std::string& path);
@@ -0,0 +1,62 @@
+#include <iostream>
+#include "core/corpus.h"
+#include "core/moves.h"
+#include "games/virtual.h"
+
+#include "harvest.h"
+
+// Consecutive games that end without an in-progress position before the board settings are given up on
+constexpr uint64_t MAX_BARREN_GAMES = 1000;
+
+uint64_t harvest_positions(const HarvestOptions& options, const std::string& path) {
+	if (options.positions == 0 || options.width <= 0 || options.height <= 0 || options.mines <= 0) {
+		throw std::runtime_error("Harvesting needs a position count, a board size and a mine count");
+	}
+	if (options.mines >= options.width * options.height) {
+		throw std::runtime_error("Harvesting needs fewer mines than tiles");
+	}
+
+	CorpusWriter writer = CorpusWriter(path);
+	uint64_t games = 0;
+	uint64_t barren_games = 0;
+	while (writer.size() < options.positions) {
+		if (barren_games == MAX_BARREN_GAMES) {
+			throw std::runtime_error("No in-progress positions in the last " + std::to_string(MAX_BARREN_GAMES)
+				+ " games, every game ends on its first moves with these board settings");
+		}
+		const uint64_t positions_before = writer.size();
+		Virtual game = Virtual(options.width, options.height, options.mines, std::chrono::milliseconds(0),
+			options.seed + static_cast<unsigned int>(games++));
+		std::shared_ptr<Board> board = game.get_board();
+
+		// Same stages as the solver, snapshotting the board after every cycle
+		while (game.status() == IN_PROGRESS && writer.size() < options.positions) {
+			std::set<Move> moves = board->discovered_count() == 0 ? first_move(*board) : basic_move(*board);
+			if (moves.empty()) {
+				moves = guess_move(*board);
+			}
+			if (moves.empty()) {
+				break;
+			}
+			for (const Move& move : moves) {
+				if (move.action == FLAG_ACTION) {
+					board->set_tile(move.x, move.y, MINE);
+					game.flag(move.x, move.y);
+				}
+				else {
+					game.click(move.x, move.y);
+				}
+			}
+			game.update();
+
+			if (game.status() == IN_PROGRESS) {
+				writer.add(*board, game.get_mine_layout());
+			}
+		}
+		barren_games = writer.size() == positions_before ? barren_games + 1 : 0;
+	}
+	writer.finish();
+
+	std::cerr << "Harvested " << writer.size() << " positions from " << games << " games into " << path << std::endl;
+	return games;
+}
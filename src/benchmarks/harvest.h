@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+struct HarvestOptions {
+	uint64_t positions = 0;
+	int width = 0;
+	int height = 0;
+	int mines = 0;
+	unsigned int seed = 0; // Seed of the first game, each following game uses the next seed
+};
+
+// Plays seeded virtual games and writes every in-progress position to a corpus file.
+// Returns the number of games played, throws if the settings stop producing positions.
+uint64_t harvest_positions(const HarvestOptions& options, const std::string& path);
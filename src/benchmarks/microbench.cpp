@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "core/analysis.h"
+#include "core/board.h"
+#include "core/corpus.h"
+#include "core/moves.h"
+#include "core/sampler.h"
+#include "core/score_kernel.h"
+#include "games/virtual.h"
+#include "utils/alloc_tracker.h"
+#include "utils/screen.h"
+
+// Microbenchmarks for the individual board, solver and virtual game operations.
+// Prints one JSON object per benchmark and fixture.
+
+#ifdef MSX_ALLOC_TRACKING
+// The allocation tracker already replaces operator new, read its counters instead
+namespace {
+    uint64_t allocations_so_far() {
+        uint64_t total = 0;
+        for (const alloc_tracker::PhaseStats& phase : alloc_tracker::thread_stats()) {
+            total += phase.allocations;
+        }
+        return total;
+    }
+
+    uint64_t bytes_so_far() {
+        uint64_t total = 0;
+        for (const alloc_tracker::PhaseStats& phase : alloc_tracker::thread_stats()) {
+            total += phase.bytes;
+        }
+        return total;
+    }
+}
+#else
+namespace {
+    std::atomic<uint64_t> allocation_count{ 0 };
+    std::atomic<uint64_t> allocation_bytes{ 0 };
+
+    uint64_t allocations_so_far() { return allocation_count.load(); }
+    uint64_t bytes_so_far() { return allocation_bytes.load(); }
+}
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+namespace {
+    constexpr int REPETITIONS = 15;
+    constexpr auto MIN_BATCH_TIME = std::chrono::milliseconds(10);
+    constexpr double TARGET_COMPLETION = 0.35; // Fraction of the board revealed in a fixture
+    constexpr unsigned int FIXTURE_SEED = 1000;
+
+    // A mid-game position taken from a seeded virtual game
+    struct Fixture {
+        int width;
+        int height;
+        int mines;
+        unsigned int seed;
+        std::shared_ptr<Virtual> game;
+        std::shared_ptr<Board> board;
+    };
+
+    Fixture make_fixture(int width, int height, int mines) {
+        for (unsigned int seed = FIXTURE_SEED; seed < FIXTURE_SEED + 1000; seed++) {
+            auto game = std::make_shared<Virtual>(width, height, mines, std::chrono::milliseconds(0), seed);
+            std::shared_ptr<Board> board = game->get_board();
+            while (game->status() == IN_PROGRESS && board->discovered_count() < width * height * TARGET_COMPLETION) {
+                std::set<Move> moves = board->discovered_count() == 0 ? first_move(*board) : basic_move(*board);
+                if (moves.empty()) {
+                    moves = guess_move(*board);
+                }
+                for (const Move& move : moves) {
+                    if (move.action == FLAG_ACTION) {
+                        board->set_tile(move.x, move.y, MINE);
+                        game->flag(move.x, move.y);
+                    }
+                    else {
+                        game->click(move.x, move.y);
+                    }
+                }
+                game->update();
+            }
+            if (game->status() == IN_PROGRESS) {
+                return { width, height, mines, seed, game, std::make_shared<Board>(*board) };
+            }
+        }
+        throw std::runtime_error("Could not build a fixture for " + std::to_string(width) + "x" + std::to_string(height));
+    }
+
+    // The score kernels must reproduce the per-component scores exactly, not just closely
+    void check_score_kernels(const Fixture& fixture, bool avx2) {
+        std::vector<TileScore> expected;
+        for (const FrontierComponent& component : split_frontier(*fixture.board)) {
+            const std::vector<TileScore> scores = analyze_component(*fixture.board, component).scores;
+            expected.insert(expected.end(), scores.begin(), scores.end());
+        }
+        std::sort(expected.begin(), expected.end(), [](const TileScore& a, const TileScore& b) {
+            return std::tie(a.y, a.x) < std::tie(b.y, b.x);
+            });
+
+        ScoreScratch scratch;
+        std::vector<TileScore> scores;
+        for (ScoreKernel kernel : { SCALAR_KERNEL, AVX2_KERNEL }) {
+            if (kernel == AVX2_KERNEL && !avx2) {
+                continue;
+            }
+            score_board(*fixture.board, scratch, scores, kernel);
+            bool same = scores.size() == expected.size();
+            for (size_t i = 0; same && i < scores.size(); i++) {
+                same = scores[i].x == expected[i].x && scores[i].y == expected[i].y &&
+                    std::memcmp(&scores[i].mine_chance, &expected[i].mine_chance, sizeof(double)) == 0 &&
+                    std::memcmp(&scores[i].score, &expected[i].score, sizeof(double)) == 0 &&
+                    scores[i].valid_neighbors == expected[i].valid_neighbors;
+            }
+            if (!same) {
+                throw std::runtime_error(std::string(kernel == SCALAR_KERNEL ? "Scalar" : "AVX2") +
+                    " score kernel differs from analyze_component at seed " + std::to_string(fixture.seed));
+            }
+        }
+    }
+
+    // Sampler estimates at growing step counts against a long reference run of the same position
+    void run_convergence(const Fixture& fixture) {
+        constexpr uint64_t REFERENCE_STEPS = 1 << 16;
+        constexpr uint64_t STEPS[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+
+        SamplerOptions options;
+        options.mines = fixture.mines;
+        options.steps = REFERENCE_STEPS;
+        options.seed = fixture.seed;
+        const SampleResult reference = sample_frontier(*fixture.board, options);
+
+        for (uint64_t steps : STEPS) {
+            options.steps = steps;
+            options.seed++;
+            const auto start = std::chrono::steady_clock::now();
+            const SampleResult result = sample_frontier(*fixture.board, options);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            double mean_error = 0.0;
+            double max_deviation = 0.0;
+            for (size_t i = 0; i < result.border.size() && i < reference.border.size(); i++) {
+                mean_error += result.border[i].error;
+                max_deviation = std::max(max_deviation, std::abs(result.border[i].probability - reference.border[i].probability));
+            }
+            if (!result.border.empty()) {
+                mean_error /= result.border.size();
+            }
+
+            std::cout << std::fixed << std::setprecision(4)
+                << "{\"benchmark\":\"sampler_convergence\""
+                << ",\"width\":" << fixture.width
+                << ",\"height\":" << fixture.height
+                << ",\"mines\":" << fixture.mines
+                << ",\"seed\":" << fixture.seed
+                << ",\"chain_steps\":" << steps
+                << ",\"time_us\":" << elapsed.count()
+                << ",\"border\":" << result.border.size()
+                << ",\"samples\":" << result.samples
+                << ",\"steps\":" << result.steps
+                << ",\"reference_samples\":" << reference.samples
+                << ",\"mean_error\":" << mean_error
+                << ",\"max_deviation\":" << max_deviation
+                << "}" << std::endl;
+        }
+    }
+
+    volatile size_t sink = 0; // Keeps benchmarked results observable
+
+    template <typename Op>
+    void run_benchmark(const std::string& name, const Fixture& fixture, Op op) {
+        using clock = std::chrono::steady_clock;
+
+        // Warm up while growing the batch until it is long enough to time reliably
+        size_t iterations = 1;
+        while (true) {
+            auto start = clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                sink = sink + op();
+            }
+            if (clock::now() - start >= MIN_BATCH_TIME) {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        for (int rep = 0; rep < REPETITIONS; rep++) {
+            const uint64_t count_before = allocations_so_far();
+            const uint64_t bytes_before = bytes_so_far();
+            auto start = clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                sink = sink + op();
+            }
+            auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            allocations += allocations_so_far() - count_before;
+            bytes += bytes_so_far() - bytes_before;
+            samples.push_back(elapsed / iterations);
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double mean = 0.0;
+        for (double s : samples) {
+            mean += s;
+        }
+        mean /= samples.size();
+        double variance = 0.0;
+        for (double s : samples) {
+            variance += (s - mean) * (s - mean);
+        }
+        const double stddev = std::sqrt(variance / (samples.size() - 1));
+        const double total_ops = static_cast<double>(iterations) * REPETITIONS;
+
+        std::cout << std::fixed << std::setprecision(1)
+            << "{\"benchmark\":\"" << name << "\""
+            << ",\"width\":" << fixture.width
+            << ",\"height\":" << fixture.height
+            << ",\"mines\":" << fixture.mines
+            << ",\"seed\":" << fixture.seed
+            << ",\"iterations\":" << iterations
+            << ",\"repetitions\":" << REPETITIONS
+            << ",\"ns_per_op_min\":" << samples.front()
+            << ",\"ns_per_op_median\":" << samples[samples.size() / 2]
+            << ",\"ns_per_op_mean\":" << mean
+            << ",\"ns_per_op_stddev\":" << stddev
+            << std::setprecision(2)
+            << ",\"allocs_per_op\":" << allocations / total_ops
+            << ",\"bytes_per_op\":" << bytes / total_ops
+            << "}" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Optional substring filter on benchmark names, and an optional position corpus
+    std::string filter;
+    std::string corpus_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--corpus" && i + 1 < argc) {
+            corpus_path = argv[++i];
+        }
+        else {
+            filter = arg;
+        }
+    }
+    auto selected = [&](const std::string& name) { return name.find(filter) != std::string::npos; };
+
+    const std::pair<int, int> sizes[] = { { 10, 10 }, { 24, 20 }, { 50, 50 } };
+    const double densities[] = { 0.10, 0.15, 0.20 };
+
+    try {
+        for (auto [width, height] : sizes) {
+            for (double density : densities) {
+                const int mines = static_cast<int>(width * height * density);
+                const Fixture fixture = make_fixture(width, height, mines);
+                const std::shared_ptr<Board> board = fixture.board;
+
+                if (selected("board_get_border_tiles")) {
+                    run_benchmark("board_get_border_tiles", fixture, [&]() { return board->get_border_tiles().size(); });
+                }
+                if (selected("basic_move")) {
+                    run_benchmark("basic_move", fixture, [&]() { return basic_move(*board).size(); });
+                }
+                if (selected("guess_move")) {
+                    run_benchmark("guess_move", fixture, [&]() { return guess_move(*board).size(); });
+                }
+                if (selected("score_board")) {
+                    const bool avx2 = avx2_supported();
+                    check_score_kernels(fixture, avx2);
+                    ScoreScratch scratch;
+                    std::vector<TileScore> scores;
+                    run_benchmark("score_board_scalar", fixture, [&]() {
+                        score_board(*board, scratch, scores, SCALAR_KERNEL);
+                        return scores.size();
+                        });
+                    if (avx2) {
+                        run_benchmark("score_board_avx2", fixture, [&]() {
+                            score_board(*board, scratch, scores, AVX2_KERNEL);
+                            return scores.size();
+                            });
+                    }
+                }
+                if (selected("analyze_board")) {
+                    AnalysisScratch scratch;
+                    AnalysisResult result;
+                    run_benchmark("analyze_board", fixture, [&]() {
+                        analyze_board(*board, scratch, result, { true, mines });
+                        return result.moves.size();
+                        });
+                }
+                if (selected("virtual_first_click")) {
+                    run_benchmark("virtual_first_click", fixture, [&]() {
+                        Virtual game(width, height, mines, std::chrono::milliseconds(0), fixture.seed);
+                        game.click(width / 2, height / 2);
+                        return static_cast<size_t>(game.status());
+                        });
+                }
+                if (selected("virtual_update")) {
+                    run_benchmark("virtual_update", fixture, [&]() {
+                        fixture.game->update();
+                        return static_cast<size_t>(fixture.game->status());
+                        });
+                }
+                if (width == 50 && selected("sampler_convergence")) {
+                    run_convergence(fixture);
+                }
+            }
+        }
+
+#ifndef _WIN32
+        // Capture latency of a hard Google board sized rectangle, shared memory against the XGetImage baseline.
+        // Needs an X server, a local Xvfb is enough: Xvfb :99 & DISPLAY=:99 msx_microbench screen_capture
+        if (selected("screen_capture")) {
+            const Dimension board_pixels(600, 500);
+            const Fixture fixture = { static_cast<int>(board_pixels.width), static_cast<int>(board_pixels.height), 0, 0, nullptr, nullptr };
+            try {
+                Screen shared({ 0, 0 }, board_pixels, SHARED_CAPTURE);
+                Screen copy({ 0, 0 }, board_pixels, COPY_CAPTURE);
+                shared.take_screenshot();
+                copy.take_screenshot();
+                run_benchmark("screen_capture_shared", fixture, [&]() {
+                    shared.take_screenshot();
+                    return static_cast<size_t>(shared.data()[0]);
+                    });
+                run_benchmark("screen_capture_copy", fixture, [&]() {
+                    copy.take_screenshot();
+                    return static_cast<size_t>(copy.data()[0]);
+                    });
+            }
+            catch (const ScreenshotException& e) {
+                std::cerr << "Skipping screen_capture: " << e.what() << std::endl;
+            }
+        }
+#endif
+
+        // Corpus benchmarks cycle through every stored position, one position per op
+        if (!corpus_path.empty()) {
+            const PositionCorpus corpus = PositionCorpus(corpus_path);
+            if (corpus.size() == 0) {
+                throw std::runtime_error("Corpus is empty: " + corpus_path);
+            }
+            const PositionView first = corpus[0];
+            const Fixture fixture = { first.get_width(), first.get_height(), first.get_mines(), 0, nullptr, nullptr };
+            uint64_t next = 0;
+
+            if (selected("corpus_scan")) {
+                run_benchmark("corpus_scan", fixture, [&]() {
+                    const PositionView position = corpus[next++ % corpus.size()];
+                    size_t undiscovered = 0;
+                    for (int i = 0; i < position.get_width() * position.get_height(); i++) {
+                        undiscovered += position.value(i) == UNDISCOVERED;
+                    }
+                    return undiscovered;
+                    });
+            }
+            if (selected("corpus_basic_move")) {
+                run_benchmark("corpus_basic_move", fixture, [&]() {
+                    return basic_move(*corpus[next++ % corpus.size()].to_board()).size();
+                    });
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
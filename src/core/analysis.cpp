@@ -0,0 +1,90 @@
+#include <algorithm>
+#include "moves.h"
+
+#include "analysis.h"
+
+void analyze_board(const Board& board, AnalysisScratch& scratch, AnalysisResult& result, const AnalysisOptions& options) {
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+    result.moves.clear();
+    result.guessed = false;
+    result.probabilities.assign(tiles.size(), NO_INFORMATION);
+
+    // Known tiles
+    int flagged = 0;
+    int undiscovered = 0;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (tiles[i].value == MINE) {
+            result.probabilities[i] = 1.0;
+            flagged++;
+        }
+        else if (tiles[i].value == UNDISCOVERED) {
+            undiscovered++;
+        }
+        else if (tiles[i].value != UNKNOWN) {
+            result.probabilities[i] = 0.0;
+        }
+    }
+    if (undiscovered == 0) {
+        return;
+    }
+    if (undiscovered == static_cast<int>(tiles.size())) {
+        if (options.guess) {
+            const std::set<Move> opening = first_move(board);
+            result.moves.assign(opening.begin(), opening.end());
+            result.guessed = true;
+        }
+        if (options.mines >= 0) {
+            std::fill(result.probabilities.begin(), result.probabilities.end(), static_cast<double>(options.mines) / tiles.size());
+        }
+        return;
+    }
+
+    // Certain moves and local estimates from every component
+    split_frontier(board, scratch.frontier, scratch.components);
+    scratch.scores.clear();
+    for (const FrontierComponent& component : scratch.components) {
+        analyze_component(board, component, scratch.component);
+        result.moves.insert(result.moves.end(), scratch.component.moves.begin(), scratch.component.moves.end());
+        scratch.scores.insert(scratch.scores.end(), scratch.component.scores.begin(), scratch.component.scores.end());
+    }
+    std::sort(result.moves.begin(), result.moves.end());
+    result.moves.erase(std::unique(result.moves.begin(), result.moves.end(), [](const Move& a, const Move& b) {
+        return !(a < b) && !(b < a);
+        }), result.moves.end());
+
+    for (const TileScore& score : scratch.scores) {
+        result.probabilities[board.to_index(score.x, score.y)] = std::clamp(score.mine_chance, 0.0, 1.0);
+    }
+    for (const Move& move : result.moves) {
+        result.probabilities[board.to_index(move.x, move.y)] = move.action == FLAG_ACTION ? 1.0 : 0.0;
+    }
+
+    // Spread the remaining mines evenly over the tiles away from the border
+    double frontier_mines = 0.0;
+    int interior_tiles = 0;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (tiles[i].value == UNDISCOVERED) {
+            if (result.probabilities[i] == NO_INFORMATION) {
+                interior_tiles++;
+            }
+            else {
+                frontier_mines += result.probabilities[i];
+            }
+        }
+    }
+    if (options.mines >= 0 && interior_tiles > 0) {
+        const double remaining = std::max(0.0, options.mines - flagged - frontier_mines);
+        const double density = std::min(1.0, remaining / interior_tiles);
+        for (size_t i = 0; i < tiles.size(); i++) {
+            if (tiles[i].value == UNDISCOVERED && result.probabilities[i] == NO_INFORMATION) {
+                result.probabilities[i] = density;
+            }
+        }
+    }
+
+    if (result.moves.empty() && options.guess) {
+        const std::set<Move> guess = guess_move(board, scratch.scores);
+        result.moves.assign(guess.begin(), guess.end());
+        result.guessed = !result.moves.empty();
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include "board.h"
+#include "move.h"
+#include "frontier.h"
+
+// Stateless board analysis. Reads only the given board and the caller's scratch buffer, so any
+// number of threads can analyse different positions at once as long as each uses its own scratch.
+
+constexpr double NO_INFORMATION = -1.0; // Probability of a tile nothing is known about
+
+struct AnalysisOptions {
+    bool guess = true; // Pick a guess when there are no certain moves
+    int mines = -1;    // Total mines on the board if known, used for tiles away from the border
+};
+
+struct AnalysisResult {
+    std::vector<Move> moves;           // Certain moves in Move order, or a single guess
+    bool guessed = false;              // True when moves holds a guess
+    std::vector<double> probabilities; // Mine probability of every tile in board order
+};
+
+// Caller-owned working memory, reused between calls to avoid reallocating
+struct AnalysisScratch {
+    FrontierScratch frontier;
+    std::vector<FrontierComponent> components;
+    ComponentAnalysis component;
+    std::vector<TileScore> scores;
+};
+
+void analyze_board(const Board& board, AnalysisScratch& scratch, AnalysisResult& result, const AnalysisOptions& options = {});
@@ -1,13 +1,16 @@
 #include <iostream>
 #include <algorithm>
-#include "utils/util.h"
+#include "fixed_board.h"
 
 #include "board.h"
 
-Board::Board(int w, int h) {
+Board::Board(int w, int h) : Board(w, h, nullptr) {}
+
+Board::Board(int w, int h, const NeighbourList* table) : neighbour_table(table) {
     height = h;
     width = w;
     tiles.resize(height * width);
+    undiscovered = height * width;
 
     // Add coordinates
     for (int i = 0; i < height; ++i) {
@@ -22,10 +25,12 @@ const Tile& Board::get_tile(int x, int y) const {
 }
 
 void Board::set_tile(int x, int y, int val) {
-    tiles[to_index(x, y)].value = val;
+    Tile& tile = tiles[to_index(x, y)];
+    undiscovered += (val == UNDISCOVERED) - (tile.value == UNDISCOVERED);
+    tile.value = val;
 }
 
-std::vector<Tile> Board::get_undiscovered_tiles() {
+std::vector<Tile> Board::get_undiscovered_tiles() const {
    std::vector<Tile> undiscovered;
    undiscovered.reserve(height * width);
 
@@ -39,19 +44,21 @@ std::vector<Tile> Board::get_undiscovered_tiles() {
 }
 
 std::vector<Tile> Board::get_surrounding_tiles(Tile t) const {
-    return surrounding_tiles<Tile>(t.x, t.y, width, height, [&](int xx, int yy) {
-        return tiles[to_index(xx, yy)];
-        });
+    std::vector<Tile> surrounding;
+    surrounding.reserve(8);
+    for (int n : neighbours(to_index(t.x, t.y))) {
+        surrounding.push_back(tiles[n]);
+    }
+    return surrounding;
 }
 
-std::vector<Tile> Board::get_border_tiles() {
+std::vector<Tile> Board::get_border_tiles() const {
     std::vector<Tile> border;
-    for (Tile tile : tiles) {
-        if (tile.value != UNDISCOVERED) {
-            std::vector<Tile> surrounding = get_surrounding_tiles(tile);
-            for (Tile s : surrounding) {
-                if (s.value == UNDISCOVERED) {
-                    border.push_back(tile);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (tiles[i].value != UNDISCOVERED) {
+            for (int n : neighbours(static_cast<int>(i))) {
+                if (tiles[n].value == UNDISCOVERED) {
+                    border.push_back(tiles[i]);
                     break;
                 }
             }
@@ -62,17 +69,28 @@ std::vector<Tile> Board::get_border_tiles() {
 
 int Board::remaining_nearby_mines(Tile t) const {
     int remaining_mines = t.value;
-    std::vector<Tile> surrounding = get_surrounding_tiles(t);
-    for (Tile s : surrounding) {
-        if (s.value == MINE) {
-
+    for (int n : neighbours(to_index(t.x, t.y))) {
+        if (tiles[n].value == MINE) {
             remaining_mines--;
         }
     }
     return remaining_mines;
 }
 
-int Board::discovered_count() {
-    return std::count_if(tiles.begin(), tiles.end(),
-        [](const Tile& tile) { return tile.value != UNDISCOVERED; });
+int Board::discovered_count() const {
+    return width * height - undiscovered;
+}
+
+std::shared_ptr<Board> make_board(int w, int h, bool specialise) {
+    if (specialise) {
+        // Standard virtual difficulties and benchmark sizes
+        if (w == 10 && h == 10) return std::make_shared<FixedBoard<10, 10>>();
+        if (w == 15 && h == 15) return std::make_shared<FixedBoard<15, 15>>();
+        if (w == 20 && h == 20) return std::make_shared<FixedBoard<20, 20>>();
+        if (w == 50 && h == 50) return std::make_shared<FixedBoard<50, 50>>();
+        if (w == 10 && h == 8) return std::make_shared<FixedBoard<10, 8>>();
+        if (w == 18 && h == 14) return std::make_shared<FixedBoard<18, 14>>();
+        if (w == 24 && h == 20) return std::make_shared<FixedBoard<24, 20>>();
+    }
+    return std::make_shared<Board>(w, h);
 }
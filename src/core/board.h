@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <memory>
+#include <tuple>
 
 constexpr int MINE = -1;
 constexpr int UNDISCOVERED = -2;
@@ -20,6 +23,31 @@ struct Tile {
     }
 };
 
+// Board indices of the up to 8 tiles around a tile, in row-major order
+struct NeighbourList {
+    int count = 0;
+    std::array<int, 8> index{};
+    const int* begin() const { return index.data(); }
+    const int* end() const { return index.data() + count; }
+};
+
+constexpr NeighbourList compute_neighbours(int x, int y, int width, int height) {
+    NeighbourList list;
+    const int start_i = y > 0 ? y - 1 : 0;
+    const int end_i = y < height - 1 ? y + 1 : height - 1;
+    const int start_j = x > 0 ? x - 1 : 0;
+    const int end_j = x < width - 1 ? x + 1 : width - 1;
+
+    for (int i = start_i; i <= end_i; i++) {
+        for (int j = start_j; j <= end_j; j++) {
+            if (i != y || j != x) {
+                list.index[list.count++] = i * width + j;
+            }
+        }
+    }
+    return list;
+}
+
 class Board {
     public:
         Board(int w, int h);
@@ -28,16 +56,30 @@ class Board {
         int get_height() const { return height; }
 		int get_width() const { return width; }
         const std::vector<Tile>& get_all_tiles() const { return tiles; }
-        std::vector<Tile> get_undiscovered_tiles();
+        std::vector<Tile> get_undiscovered_tiles() const;
         std::vector<Tile> get_surrounding_tiles(Tile t) const;
-        std::vector<Tile> get_border_tiles();
+        std::vector<Tile> get_border_tiles() const;
 		int remaining_nearby_mines(Tile t) const;
-        int discovered_count();
+        int discovered_count() const;
+        int undiscovered_count() const { return undiscovered; } // Kept up to date by set_tile
+
+        // Neighbours come from a precomputed table on fixed boards and are computed on the fly otherwise
+        NeighbourList neighbours(int index) const {
+            return neighbour_table ? neighbour_table[index] : compute_neighbours(index % width, index / width, width, height);
+        }
+        bool is_specialised() const { return neighbour_table != nullptr; }
+        inline int to_index(int x, int y) const { return y * width + x;  }
+
+    protected:
+        Board(int w, int h, const NeighbourList* table);
 
     private:
         int height;
         int width;
         std::vector<Tile> tiles;
-
-        inline int to_index(int x, int y) const { return y * width + x;  }
+        int undiscovered = 0;
+        const NeighbourList* neighbour_table = nullptr; // Static storage, shared by every board of the same size
 };
+
+// Creates a FixedBoard for the standard sizes when specialise is set, and a generic board otherwise
+std::shared_ptr<Board> make_board(int w, int h, bool specialise = true);
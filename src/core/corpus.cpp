@@ -0,0 +1,232 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+
+#include "corpus.h"
+
+static size_t cell_plane_size(int width, int height) {
+    return (static_cast<size_t>(width) * height + 1) / 2;
+}
+
+static size_t mine_plane_size(int width, int height) {
+    return (static_cast<size_t>(width) * height + 7) / 8;
+}
+
+static size_t padded(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+static size_t record_size(int width, int height) {
+    return padded(sizeof(PositionHeader) + cell_plane_size(width, height) + mine_plane_size(width, height));
+}
+
+static uint8_t encode_cell(int value) {
+    switch (value) {
+    case UNDISCOVERED:
+        return CELL_UNDISCOVERED;
+    case MINE:
+        return CELL_MINE;
+    case UNKNOWN:
+        return CELL_UNKNOWN;
+    default:
+        return static_cast<uint8_t>(value);
+    }
+}
+
+// Position view
+
+int PositionView::value(int index) const {
+    const uint8_t code = (cells()[index / 2] >> ((index % 2) * 4)) & 0x0F;
+    switch (code) {
+    case CELL_UNDISCOVERED:
+        return UNDISCOVERED;
+    case CELL_MINE:
+        return MINE;
+    case CELL_UNKNOWN:
+        return UNKNOWN;
+    default:
+        return code;
+    }
+}
+
+const uint8_t* PositionView::mine_plane() const {
+    return cells() + cell_plane_size(header->width, header->height);
+}
+
+bool PositionView::is_mine(int index) const {
+    return (mine_plane()[index / 8] >> (index % 8)) & 1;
+}
+
+std::shared_ptr<Board> PositionView::to_board() const {
+    std::shared_ptr<Board> board = make_board(header->width, header->height);
+    for (int y = 0; y < header->height; y++) {
+        for (int x = 0; x < header->width; x++) {
+            board->set_tile(x, y, value(y * header->width + x));
+        }
+    }
+    return board;
+}
+
+// Corpus writer
+
+CorpusWriter::CorpusWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {
+    if (!out) {
+        throw CorpusException("Could not open corpus for writing: " + path);
+    }
+    CorpusHeader header{};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header)); // Filled in by finish()
+}
+
+CorpusWriter::~CorpusWriter() {
+    if (!finished) {
+        try {
+            finish();
+        }
+        catch (...) {}
+    }
+}
+
+void CorpusWriter::add(const Board& board, const std::vector<bool>& mines) {
+    const int width = board.get_width();
+    const int height = board.get_height();
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+    if (width > UINT16_MAX || height > UINT16_MAX) {
+        throw CorpusException("Board of " + std::to_string(width) + "x" + std::to_string(height) + " is too large for a corpus");
+    }
+
+    PositionHeader header{};
+    header.width = static_cast<uint16_t>(width);
+    header.height = static_cast<uint16_t>(height);
+    for (bool mine : mines) {
+        header.mines += mine;
+    }
+
+    std::vector<uint8_t> record(record_size(width, height), 0);
+    std::memcpy(record.data(), &header, sizeof(header));
+    uint8_t* cells = record.data() + sizeof(header);
+    uint8_t* mine_plane = cells + cell_plane_size(width, height);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        cells[i / 2] |= encode_cell(tiles[i].value) << ((i % 2) * 4);
+        if (mines[i]) {
+            mine_plane[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    offsets.push_back(static_cast<uint64_t>(out.tellp()));
+    out.write(reinterpret_cast<const char*>(record.data()), record.size());
+}
+
+void CorpusWriter::finish() {
+    finished = true;
+    CorpusHeader header{};
+    std::memcpy(header.magic, CORPUS_MAGIC, sizeof(header.magic));
+    header.version = CORPUS_VERSION;
+    header.byte_order = CORPUS_BYTE_ORDER;
+    header.position_count = offsets.size();
+    header.index_offset = static_cast<uint64_t>(out.tellp());
+    header.data_offset = sizeof(CorpusHeader);
+
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        throw CorpusException("Failed to write corpus");
+    }
+}
+
+// Position corpus
+
+PositionCorpus::PositionCorpus(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw CorpusException("Could not open corpus: " + path);
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        throw CorpusException("Could not map corpus: " + path);
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    length = static_cast<size_t>(file_size.QuadPart);
+    data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw CorpusException("Could not open corpus: " + path);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    length = static_cast<size_t>(st.st_size);
+    void* mapped = length > 0 ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    data = mapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapped);
+#endif
+    if (data == nullptr || length < sizeof(CorpusHeader)) {
+        unmap();
+        throw CorpusException("Could not map corpus: " + path);
+    }
+
+    header = reinterpret_cast<const CorpusHeader*>(data);
+    if (std::memcmp(header->magic, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) != 0 || header->version != CORPUS_VERSION) {
+        unmap();
+        throw CorpusException("Not a version " + std::to_string(CORPUS_VERSION) + " corpus: " + path);
+    }
+    if (header->byte_order != CORPUS_BYTE_ORDER) {
+        unmap();
+        throw CorpusException("Corpus was written with a different byte order: " + path);
+    }
+
+    // Subtractions only, so corrupt offsets cannot overflow past the checks
+    const uint64_t index_offset = header->index_offset;
+    if (index_offset < sizeof(CorpusHeader) || index_offset > length || index_offset % sizeof(uint64_t) != 0
+        || header->position_count > (length - index_offset) / sizeof(uint64_t)) {
+        unmap();
+        throw CorpusException("Truncated corpus: " + path);
+    }
+    index = reinterpret_cast<const uint64_t*>(data + index_offset);
+
+    // Every record has to lie between the header and the index
+    for (uint64_t i = 0; i < header->position_count; i++) {
+        const uint64_t offset = index[i];
+        if (offset < sizeof(CorpusHeader) || offset > index_offset || offset % alignof(PositionHeader) != 0
+            || index_offset - offset < sizeof(PositionHeader)) {
+            unmap();
+            throw CorpusException("Corrupt record offset in corpus: " + path);
+        }
+        const PositionHeader* position = reinterpret_cast<const PositionHeader*>(data + offset);
+        if (position->width == 0 || position->height == 0 || index_offset - offset < record_size(position->width, position->height)) {
+            unmap();
+            throw CorpusException("Corrupt record in corpus: " + path);
+        }
+    }
+}
+
+PositionCorpus::~PositionCorpus() {
+    unmap();
+}
+
+void PositionCorpus::unmap() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mapping_handle) CloseHandle(mapping_handle);
+    if (file_handle) CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    if (data) munmap(const_cast<uint8_t*>(data), length);
+#endif
+    data = nullptr;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Binary corpus of board positions with their ground-truth mine layouts.
+//
+// Integers are in the native byte order of the machine that wrote the file, which the header records so a reader
+// on a machine with the other order rejects it. The file starts with a CorpusHeader, followed by the position
+// records and then an index of uint64 record offsets (from the start of the file) for random access.
+// Each record is a PositionHeader, a cell plane with 4 bits per tile (low nibble first) and a mine
+// plane with 1 bit per tile (least significant bit first), padded to 8 bytes. Every offset is checked against the
+// file size when it is opened, so a truncated or corrupt corpus is rejected up front.
+
+constexpr char CORPUS_MAGIC[4] = { 'M', 'S', 'X', 'C' };
+constexpr uint16_t CORPUS_VERSION = 2;
+constexpr uint16_t CORPUS_BYTE_ORDER = 0x0102; // Reads back as 0x0201 with the other byte order
+
+// Cell codes above the tile numbers (0-8)
+constexpr uint8_t CELL_UNDISCOVERED = 9;
+constexpr uint8_t CELL_MINE = 10;
+constexpr uint8_t CELL_UNKNOWN = 11;
+
+struct CorpusHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint64_t position_count;
+    uint64_t index_offset;
+    uint64_t data_offset;
+};
+
+struct PositionHeader {
+    uint16_t width;
+    uint16_t height;
+    uint32_t mines;
+};
+
+static_assert(sizeof(CorpusHeader) == 32, "Corpus header must be packed");
+static_assert(sizeof(PositionHeader) == 8, "Position header must be packed");
+
+class CorpusException : public std::runtime_error {
+public:
+    explicit CorpusException(const std::string& message) : std::runtime_error(message) {}
+};
+
+// Read-only view of one position inside a mapped corpus
+class PositionView {
+public:
+    explicit PositionView(const uint8_t* record) : header(reinterpret_cast<const PositionHeader*>(record)) {}
+    int get_width() const { return header->width; }
+    int get_height() const { return header->height; }
+    int get_mines() const { return static_cast<int>(header->mines); }
+
+    // Tile value in board terms (0-8, MINE, UNDISCOVERED or UNKNOWN)
+    int value(int index) const;
+    bool is_mine(int index) const;
+
+    // Copies the position into a board for the solver
+    std::shared_ptr<Board> to_board() const;
+
+private:
+    const PositionHeader* header;
+    const uint8_t* cells() const { return reinterpret_cast<const uint8_t*>(header + 1); }
+    const uint8_t* mine_plane() const;
+};
+
+// Streams positions into a new corpus file
+class CorpusWriter {
+public:
+    explicit CorpusWriter(const std::string& path);
+    ~CorpusWriter();
+    void add(const Board& board, const std::vector<bool>& mines);
+    void finish();
+    uint64_t size() const { return offsets.size(); }
+
+private:
+    std::ofstream out;
+    std::vector<uint64_t> offsets;
+    bool finished = false;
+};
+
+// Memory-mapped corpus, positions are read in place without parsing or copying
+class PositionCorpus {
+public:
+    explicit PositionCorpus(const std::string& path);
+    ~PositionCorpus();
+    PositionCorpus(const PositionCorpus&) = delete;
+    PositionCorpus& operator=(const PositionCorpus&) = delete;
+
+    uint64_t size() const { return header->position_count; }
+    PositionView operator[](uint64_t i) const { return PositionView(data + index[i]); }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    const CorpusHeader* header = nullptr;
+    const uint64_t* index = nullptr;
+    void unmap();
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
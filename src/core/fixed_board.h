@@ -0,0 +1,23 @@
+#pragma once
+#include <array>
+#include "board.h"
+
+template <int W, int H>
+constexpr std::array<NeighbourList, W * H> make_neighbour_table() {
+    std::array<NeighbourList, W * H> table{};
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            table[y * W + x] = compute_neighbours(x, y, W, H);
+        }
+    }
+    return table;
+}
+
+// Board with its size fixed at compile time, so neighbour lookups are served from a constexpr table
+template <int W, int H>
+class FixedBoard : public Board {
+public:
+    static constexpr std::array<NeighbourList, W * H> NEIGHBOURS = make_neighbour_table<W, H>();
+
+    FixedBoard() : Board(W, H, NEIGHBOURS.data()) {}
+};
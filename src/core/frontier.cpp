@@ -0,0 +1,196 @@
+#include <algorithm>
+#include "frontier.h"
+
+static void hash_combine(uint64_t& hash, int64_t value) {
+    hash ^= static_cast<uint64_t>(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+}
+
+std::vector<FrontierComponent> split_frontier(const Board& board) {
+    FrontierScratch scratch;
+    std::vector<FrontierComponent> components;
+    split_frontier(board, scratch, components);
+    return components;
+}
+
+void split_frontier(const Board& board, FrontierScratch& scratch, std::vector<FrontierComponent>& components) {
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+
+    auto is_constraint = [&](int index) {
+        if (tiles[index].value < 0) {
+            return false;
+        }
+        for (int n : board.neighbours(index)) {
+            if (tiles[n].value == UNDISCOVERED) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Flood fill constraint -> undiscovered -> constraint until each component is closed
+    std::vector<bool>& visited = scratch.visited;
+    std::vector<int>& stack = scratch.stack;
+    std::vector<int>& constraint_indices = scratch.constraint_indices;
+    std::vector<int>& unknown_indices = scratch.unknown_indices;
+    visited.assign(tiles.size(), false);
+    size_t count = 0;
+    for (int start = 0; start < static_cast<int>(tiles.size()); start++) {
+        if (visited[start] || !is_constraint(start)) {
+            continue;
+        }
+
+        constraint_indices.clear();
+        unknown_indices.clear();
+        visited[start] = true;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const int current = stack.back();
+            stack.pop_back();
+            const Tile& t = tiles[current];
+            const bool undiscovered = t.value == UNDISCOVERED;
+            (undiscovered ? unknown_indices : constraint_indices).push_back(current);
+
+            for (int n : board.neighbours(current)) {
+                // Neighbours of an undiscovered tile with a value are always constraints
+                if (!visited[n] && ((!undiscovered && tiles[n].value == UNDISCOVERED) || (undiscovered && tiles[n].value >= 0))) {
+                    visited[n] = true;
+                    stack.push_back(n);
+                }
+            }
+        }
+
+        // Sort so the hash does not depend on the fill order
+        std::sort(constraint_indices.begin(), constraint_indices.end());
+        std::sort(unknown_indices.begin(), unknown_indices.end());
+
+        if (count == components.size()) {
+            components.emplace_back();
+        }
+        FrontierComponent& component = components[count++];
+        component.constraints.clear();
+        component.unknowns.clear();
+        component.key.clear();
+        for (int index : constraint_indices) {
+            const Tile& t = tiles[index];
+            component.constraints.push_back(t);
+            component.key.push_back(index);
+            component.key.push_back(t.value);
+            for (int n : board.neighbours(index)) {
+                component.key.push_back(tiles[n].value);
+            }
+        }
+        component.hash = 0;
+        for (int value : component.key) {
+            hash_combine(component.hash, value);
+        }
+        for (int index : unknown_indices) {
+            component.unknowns.push_back(tiles[index]);
+        }
+    }
+    components.resize(count);
+}
+
+ComponentAnalysis analyze_component(const Board& board, const FrontierComponent& component) {
+    ComponentAnalysis analysis;
+    analyze_component(board, component, analysis);
+    return analysis;
+}
+
+void analyze_component(const Board& board, const FrontierComponent& component, ComponentAnalysis& analysis) {
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+    analysis.moves.clear();
+    analysis.scores.clear();
+
+    // Certain moves from each constraint on its own
+    for (const Tile& t : component.constraints) {
+        const NeighbourList surrounding = board.neighbours(board.to_index(t.x, t.y));
+        int remaining_mines = board.remaining_nearby_mines(t);
+        int undiscovered_count = 0;
+        for (int n : surrounding) {
+            undiscovered_count += tiles[n].value == UNDISCOVERED;
+        }
+
+        double mine_chance = static_cast<double>(remaining_mines) / undiscovered_count;
+        if (mine_chance != 1 && mine_chance != 0) {
+            continue;
+        }
+        for (int n : surrounding) {
+            if (tiles[n].value == UNDISCOVERED) {
+                analysis.moves.insert({ mine_chance == 1 ? FLAG_ACTION : CLICK_ACTION, tiles[n].x, tiles[n].y });
+            }
+        }
+    }
+
+    // Guess scores, averaging the local mine chance of every numbered neighbour
+    for (const Tile& t : component.unknowns) {
+        double cumulative_prob = 0.0;
+        int valid_neighbors = 0;
+
+        for (int s_index : board.neighbours(board.to_index(t.x, t.y))) {
+            const Tile& s = tiles[s_index];
+            if (s.value <= 0) { // Only consider numbered tiles
+                continue;
+            }
+
+            int undiscovered_count = 0;
+            bool valid_calculation = true;
+            for (int n : board.neighbours(s_index)) {
+                valid_calculation &= tiles[n].value != UNKNOWN;
+                undiscovered_count += tiles[n].value == UNDISCOVERED;
+            }
+
+            if (valid_calculation && undiscovered_count > 0) {
+                cumulative_prob += static_cast<double>(board.remaining_nearby_mines(s)) / undiscovered_count;
+                valid_neighbors++;
+            }
+        }
+
+        if (valid_neighbors > 0) {
+            double avg_probability = cumulative_prob / valid_neighbors;
+
+            // Apply neighbor bonus (weighted less heavily than in original)
+            double neighbor_bonus = 1.0 + (valid_neighbors / 12.0);
+            analysis.scores.push_back({ t.x, t.y, avg_probability, avg_probability / neighbor_bonus, valid_neighbors });
+        }
+    }
+}
+
+// Component cache
+
+ComponentCache::ComponentCache(size_t c) : capacity(std::max<size_t>(c, 1)) {}
+
+const ComponentAnalysis* ComponentCache::find(const FrontierComponent& component) {
+    auto it = index.find(component.hash);
+    if (it == index.end() || it->second->key != component.key) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->analysis;
+}
+
+const ComponentAnalysis& ComponentCache::insert(const FrontierComponent& component, ComponentAnalysis analysis) {
+    // One entry per hash, a colliding component replaces the one stored before it
+    auto it = index.find(component.hash);
+    if (it != index.end()) {
+        it->second->key = component.key;
+        it->second->analysis = std::move(analysis);
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->analysis;
+    }
+
+    if (entries.size() >= capacity) {
+        index.erase(entries.back().hash);
+        entries.pop_back();
+        evictions++;
+    }
+    entries.push_front({ component.hash, component.key, std::move(analysis) });
+    index[component.hash] = entries.begin();
+    return entries.front().analysis;
+}
+
+void ComponentCache::clear() {
+    entries.clear();
+    index.clear();
+}
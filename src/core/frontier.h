@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "board.h"
+#include "move.h"
+
+// Guess score of an undiscovered tile, derived from its numbered neighbours
+struct TileScore {
+    int x;
+    int y;
+    double mine_chance; // Average local mine chance of the numbered neighbours
+    double score;       // Mine chance weighted by the amount of information, lower is safer
+    int valid_neighbors;
+};
+
+// A group of border constraints that share no undiscovered tiles with any other group
+struct FrontierComponent {
+    std::vector<Tile> constraints; // Discovered tiles touching the component
+    std::vector<Tile> unknowns;    // Undiscovered tiles touching the constraints
+    std::vector<int> key;          // Index and value of every constraint followed by its neighbours' values
+    uint64_t hash = 0;             // Hash of the key
+};
+
+// Everything the solver derives from a single component
+struct ComponentAnalysis {
+    std::set<Move> moves;          // Certain moves (clicks and flags)
+    std::vector<TileScore> scores; // Guess scores for unknowns with usable information
+};
+
+// Reusable working memory for split_frontier
+struct FrontierScratch {
+    std::vector<bool> visited;
+    std::vector<int> stack;
+    std::vector<int> constraint_indices;
+    std::vector<int> unknown_indices;
+};
+
+std::vector<FrontierComponent> split_frontier(const Board& board);
+ComponentAnalysis analyze_component(const Board& board, const FrontierComponent& component);
+
+// Variants that reuse caller-owned buffers, existing entries of components are recycled
+void split_frontier(const Board& board, FrontierScratch& scratch, std::vector<FrontierComponent>& components);
+void analyze_component(const Board& board, const FrontierComponent& component, ComponentAnalysis& analysis);
+
+// Bounded LRU cache of component analyses, indexed by component hash. A hit also compares the full key, so
+// components whose hashes collide never share an analysis
+class ComponentCache {
+public:
+    explicit ComponentCache(size_t capacity = 4096);
+    const ComponentAnalysis* find(const FrontierComponent& component);
+    const ComponentAnalysis& insert(const FrontierComponent& component, ComponentAnalysis analysis);
+    void clear();
+    size_t size() const { return entries.size(); }
+    size_t get_hits() const { return hits; }
+    size_t get_misses() const { return misses; }
+    size_t get_evictions() const { return evictions; }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::vector<int> key;
+        ComponentAnalysis analysis;
+    };
+    size_t capacity;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+};
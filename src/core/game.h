@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <stdexcept>
 #include "board.h"
 
 enum Status {
@@ -17,12 +18,16 @@ public:
     virtual void click(int x, int y) = 0;
     virtual void flag(int x, int y) = 0;
     virtual int get_failed_cycle_threshold() = 0;
+    virtual int get_mine_count() const { return -1; } // Total mines on the board, -1 if unknown
+    virtual bool supports_chord() const { return false; } // Whether chord() is available
+    // Reveals every unflagged neighbour of a number with as many flags around it, in one input
+    virtual void chord(int, int) { throw std::runtime_error(name + " does not support chording"); }
     std::shared_ptr<Board> get_board() const { return board; }
     std::chrono::milliseconds get_move_delay() const { return move_delay; }
 
 protected:
-    Game(std::string n, int w, int h, std::chrono::milliseconds md) : name(n), width(w), height(h),
-        move_delay(md), board(std::make_shared<Board>(w, h)) {}
+    Game(std::string n, int w, int h, std::chrono::milliseconds md, bool specialise = true) : name(n), width(w), height(h),
+        move_delay(md), board(make_board(w, h, specialise)) {}
     std::string name;
     int width;
     int height;
@@ -0,0 +1,22 @@
+#pragma once
+
+enum Action {
+    CLICK_ACTION,
+    FLAG_ACTION,
+    CHORD_ACTION // Reveals every unflagged neighbour of a satisfied number, ordered after the flags it relies on
+};
+
+struct Move {
+    Action action;
+    int x;
+    int y;
+
+    // For set operations
+    bool operator<(const Move& other) const {
+        if (action != other.action)
+            return action < other.action;
+        if (x != other.x)
+            return x < other.x;
+        return y < other.y;
+    }
+};
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <tuple>
+#include "score_kernel.h"
+
+#include "moves.h"
+
+std::set<Move> first_move(const Board& board) {
+    return { { CLICK_ACTION, board.get_width() / 2, board.get_height() / 2 } };
+}
+
+// Fallback when no tile has any information
+static std::set<Move> first_undiscovered(const Board& board) {
+    for (const Tile& tile : board.get_all_tiles()) {
+        if (tile.value == UNDISCOVERED) {
+            return { { CLICK_ACTION, tile.x, tile.y } };
+        }
+    }
+    return std::set<Move>();
+}
+
+std::set<Move> guess_move(const Board& board, std::vector<TileScore>& scores, bool neighbour_bonus) {
+    // Ties are broken in board order, so visit the tiles row by row
+    std::sort(scores.begin(), scores.end(), [](const TileScore& a, const TileScore& b) {
+        return std::tie(a.y, a.x) < std::tie(b.y, b.x);
+        });
+
+    const TileScore* best = nullptr;
+    double lowest_mine_probability = 1.0;
+    int best_valid_neighbors = 0;
+    for (const TileScore& score : scores) {
+        const double value = neighbour_bonus ? score.score : score.mine_chance;
+        if (value < lowest_mine_probability ||
+            (value == lowest_mine_probability && score.valid_neighbors > best_valid_neighbors)) {
+            lowest_mine_probability = value;
+            best = &score;
+            best_valid_neighbors = score.valid_neighbors;
+        }
+    }
+
+    if (best == nullptr) {
+        return first_undiscovered(board);
+    }
+    return { { CLICK_ACTION, best->x, best->y } };
+}
+
+std::set<Move> basic_move(const Board& board, bool chord) {
+    std::set<Move> moves;
+    for (const FrontierComponent& component : split_frontier(board)) {
+        std::set<Move> component_moves = analyze_component(board, component).moves;
+        moves.insert(component_moves.begin(), component_moves.end());
+    }
+    return chord ? chord_moves(board, moves) : moves;
+}
+
+std::set<Move> chord_moves(const Board& board, const std::set<Move>& moves) {
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+    std::vector<uint8_t> pending(tiles.size(), 0); // 1 for a click still to send, 2 for a flag in this batch
+    for (const Move& move : moves) {
+        pending[board.to_index(move.x, move.y)] = move.action == FLAG_ACTION ? 2 : move.action == CLICK_ACTION;
+    }
+
+    std::set<Move> result;
+    for (const Move& move : moves) {
+        if (move.action != CLICK_ACTION) {
+            result.insert(move);
+        }
+    }
+
+    // Numbers are visited in board order, a chord only covers clicks no earlier chord took
+    for (int i = 0; i < static_cast<int>(tiles.size()); i++) {
+        if (tiles[i].value <= 0) {
+            continue;
+        }
+        int flags = 0;
+        int clicks = 0;
+        bool covered = true;
+        for (int n : board.neighbours(i)) {
+            if (tiles[n].value == MINE || pending[n] == 2) {
+                flags++;
+            }
+            else if (tiles[n].value < 0) {
+                clicks += pending[n] == 1;
+                covered &= pending[n] != 0; // A chord would also reveal any unflagged tile not known to be safe
+            }
+        }
+        if (flags != tiles[i].value || !covered || clicks < 2) {
+            continue;
+        }
+        for (int n : board.neighbours(i)) {
+            if (pending[n] == 1) {
+                pending[n] = 3; // Revealed by this chord
+            }
+        }
+        result.insert({ CHORD_ACTION, tiles[i].x, tiles[i].y });
+    }
+
+    for (const Move& move : moves) {
+        if (move.action == CLICK_ACTION && pending[board.to_index(move.x, move.y)] == 1) {
+            result.insert(move);
+        }
+    }
+    return result;
+}
+
+std::set<Move> guess_move(const Board& board) {
+    // Same scores as analysing every component, from the whole-board kernel
+    thread_local ScoreScratch scratch;
+    thread_local std::vector<TileScore> scores;
+    score_board(board, scratch, scores);
+    return guess_move(board, scores);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <set>
+#include <vector>
+#include "board.h"
+#include "move.h"
+#include "frontier.h"
+
+// Move generation stages used by the solver
+
+// Opening click in the middle of an untouched board
+std::set<Move> first_move(const Board& board);
+
+// Certain clicks and flags from every border constraint, with clicks merged into chords when chord is set
+std::set<Move> basic_move(const Board& board, bool chord = false);
+
+// Replaces the clicks around a number with one chord when the batch's flags satisfy it and it saves at least one input
+std::set<Move> chord_moves(const Board& board, const std::set<Move>& moves);
+
+// Single click on the tile with the lowest guess score, or the lowest mine chance without the neighbour bonus
+std::set<Move> guess_move(const Board& board);
+std::set<Move> guess_move(const Board& board, std::vector<TileScore>& scores, bool neighbour_bonus = true);
@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <random>
+#include "work_pool.h"
+
+#include "sampler.h"
+
+namespace {
+    constexpr int BATCHES = 16;             // Step slices per chain for the batch means error
+    constexpr double BURN_IN = 0.1;         // Fraction of the steps before samples are counted
+    constexpr int CLOCK_INTERVAL = 64;      // Block updates between time cap checks
+    constexpr uint64_t SEARCH_LIMIT = 1 << 20; // Nodes the initial search may visit
+    constexpr int MAX_BLOCK = 16;
+
+    // Border tiles and the revealed numbers around them
+    struct Frontier {
+        std::vector<int> cells;                         // Board index of each border tile
+        std::vector<int> targets;                       // Unflagged mines each constraint still needs
+        std::vector<std::vector<int>> constraint_cells;
+        std::vector<std::vector<int>> cell_constraints;
+        std::vector<std::vector<int>> cell_neighbours;  // Border tiles sharing a constraint
+        std::vector<int> order;                         // Breadth-first along the border, keeps constraints close together
+        int interior = 0;                               // Undiscovered tiles away from the border
+        int remaining = -1;                             // Unflagged mines on the whole board, -1 if unknown
+    };
+
+    Frontier build_frontier(const Board& board, int mines) {
+        const std::vector<Tile>& tiles = board.get_all_tiles();
+        const int size = static_cast<int>(tiles.size());
+        std::vector<int> cell_of(size, -1);
+        Frontier frontier;
+        int flagged = 0;
+
+        for (int i = 0; i < size; i++) {
+            flagged += tiles[i].value == MINE;
+            if (tiles[i].value < 0) {
+                continue;
+            }
+
+            // Constraints next to unrecognised tiles cannot be trusted
+            int target = tiles[i].value;
+            bool usable = true;
+            bool touches_undiscovered = false;
+            for (int n : board.neighbours(i)) {
+                target -= tiles[n].value == MINE;
+                usable &= tiles[n].value != UNKNOWN;
+                touches_undiscovered |= tiles[n].value == UNDISCOVERED;
+            }
+            if (!usable || !touches_undiscovered) {
+                continue;
+            }
+
+            const int constraint = static_cast<int>(frontier.targets.size());
+            frontier.targets.push_back(target);
+            frontier.constraint_cells.emplace_back();
+            for (int n : board.neighbours(i)) {
+                if (tiles[n].value != UNDISCOVERED) {
+                    continue;
+                }
+                if (cell_of[n] < 0) {
+                    cell_of[n] = static_cast<int>(frontier.cells.size());
+                    frontier.cells.push_back(n);
+                    frontier.cell_constraints.emplace_back();
+                }
+                frontier.cell_constraints[cell_of[n]].push_back(constraint);
+                frontier.constraint_cells[constraint].push_back(cell_of[n]);
+            }
+        }
+
+        const int cells = static_cast<int>(frontier.cells.size());
+        frontier.cell_neighbours.resize(cells);
+        for (int cell = 0; cell < cells; cell++) {
+            std::vector<int>& neighbours = frontier.cell_neighbours[cell];
+            for (int c : frontier.cell_constraints[cell]) {
+                for (int other : frontier.constraint_cells[c]) {
+                    if (other != cell && std::find(neighbours.begin(), neighbours.end(), other) == neighbours.end()) {
+                        neighbours.push_back(other);
+                    }
+                }
+            }
+        }
+
+        std::vector<bool> queued(cells, false);
+        for (int root = 0; root < cells; root++) {
+            if (queued[root]) {
+                continue;
+            }
+            queued[root] = true;
+            frontier.order.push_back(root);
+            for (size_t head = frontier.order.size() - 1; head < frontier.order.size(); head++) {
+                for (int next : frontier.cell_neighbours[frontier.order[head]]) {
+                    if (!queued[next]) {
+                        queued[next] = true;
+                        frontier.order.push_back(next);
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < size; i++) {
+            frontier.interior += tiles[i].value == UNDISCOVERED && cell_of[i] < 0;
+        }
+        frontier.remaining = mines >= 0 ? mines - flagged : -1;
+        return frontier;
+    }
+
+    // Sums of the valid layouts seen in one step slice of one chain
+    struct Batch {
+        std::vector<double> mines;
+        double interior = 0.0;
+        uint64_t samples = 0;
+    };
+
+    class Chain {
+    public:
+        Chain(const Frontier& f, const SamplerOptions& o, uint64_t seed) : frontier(f), generator(seed),
+            block_limit(std::clamp(o.block_size, 1, MAX_BLOCK)), mine(f.cells.size(), 0), counts(f.targets.size(), 0),
+            cell_mark(f.cells.size(), 0), constraint_mark(f.targets.size(), 0), local_of(f.targets.size(), -1),
+            batches(BATCHES) {
+            for (Batch& batch : batches) {
+                batch.mines.assign(f.cells.size(), 0.0);
+            }
+        }
+
+        // Without a deadline the chain depends on nothing but its seed. Chains run one after another when the pool
+        // runs the loop inline, so one that starts past the deadline skips its search as well
+        void run(uint64_t step_count, std::optional<std::chrono::steady_clock::time_point> deadline) {
+            if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+                return;
+            }
+            if (!initialise()) {
+                return;
+            }
+            const int cells = static_cast<int>(frontier.cells.size());
+            std::uniform_int_distribution<int> pick_cell(0, cells - 1);
+
+            // One layout per sweep over the border keeps consecutive samples from being near copies
+            const uint64_t interval = std::max(1, cells / block_limit);
+            const uint64_t burn_in = static_cast<uint64_t>(step_count * BURN_IN);
+            for (uint64_t step = 0; step < step_count; step++) {
+                if (deadline && step % CLOCK_INTERVAL == 0 && std::chrono::steady_clock::now() >= *deadline) {
+                    break;
+                }
+                if (step % interval == 0 && step >= burn_in && allowed(border_mines)) {
+                    record(static_cast<int>(step * BATCHES / step_count));
+                }
+                update(pick_cell(generator));
+                steps++;
+            }
+        }
+
+        const std::vector<Batch>& get_batches() const { return batches; }
+        uint64_t get_steps() const { return steps; }
+
+    private:
+        struct Layout {
+            uint32_t mask;
+            int mines;
+        };
+
+        const Frontier& frontier;
+        std::mt19937_64 generator;
+        const int block_limit;
+        std::vector<uint8_t> mine;
+        std::vector<int> counts; // Mines currently around each constraint
+        int border_mines = 0;
+
+        // Scratch for one block update
+        std::vector<uint32_t> cell_mark;
+        std::vector<uint32_t> constraint_mark;
+        std::vector<int> local_of;
+        uint32_t stamp = 0;
+        std::vector<int> block;
+        std::vector<int> need; // Mines each constraint still needs from the unassigned part of the block
+        std::vector<int> left; // Unassigned block tiles around each constraint
+        std::vector<Layout> layouts;
+        std::vector<double> weights;
+
+        std::vector<Batch> batches;
+        uint64_t steps = 0;
+
+        // Depth-first search along the border for a layout satisfying every constraint, values tried in random order
+        bool initialise() {
+            const std::vector<int>& order = frontier.order;
+            const int cells = static_cast<int>(order.size());
+            need = frontier.targets;
+            left.assign(frontier.targets.size(), 0);
+            for (size_t c = 0; c < left.size(); c++) {
+                left[c] = static_cast<int>(frontier.constraint_cells[c].size());
+            }
+
+            std::vector<uint8_t> tried(cells, 0);
+            std::vector<uint8_t> first(cells, 0);
+            std::bernoulli_distribution coin;
+            uint64_t nodes = 0;
+            for (int pos = 0; pos < cells;) {
+                if (tried[pos] == 2) {
+                    tried[pos] = 0;
+                    if (pos == 0) {
+                        return false;
+                    }
+                    unassign(order[--pos]);
+                    continue;
+                }
+                if (++nodes > SEARCH_LIMIT) {
+                    return false;
+                }
+                if (tried[pos] == 0) {
+                    first[pos] = coin(generator);
+                }
+                const int value = tried[pos]++ == 0 ? first[pos] : 1 - first[pos];
+                if (assign(order[pos], value)) {
+                    pos++;
+                }
+                else {
+                    unassign(order[pos]);
+                }
+            }
+
+            counts = frontier.targets;
+            border_mines = 0;
+            for (uint8_t m : mine) {
+                border_mines += m;
+            }
+            return true;
+        }
+
+        // Whether the constraints around the tile can still be met
+        bool assign(int cell, int value) {
+            bool valid = true;
+            mine[cell] = static_cast<uint8_t>(value);
+            for (int c : frontier.cell_constraints[cell]) {
+                need[c] -= value;
+                left[c]--;
+                valid &= need[c] >= 0 && need[c] <= left[c];
+            }
+            return valid;
+        }
+
+        void unassign(int cell) {
+            for (int c : frontier.cell_constraints[cell]) {
+                need[c] += mine[cell];
+                left[c]++;
+            }
+            mine[cell] = 0;
+        }
+
+        // Whether k border mines leave a valid number of interior mines
+        bool allowed(int k) const {
+            if (frontier.remaining < 0) {
+                return k >= 0;
+            }
+            return k >= 0 && k <= frontier.remaining && frontier.remaining - k <= frontier.interior;
+        }
+
+        // Log of the interior placements for k border mines, up to a constant. Impossible counts are pushed far
+        // below every possible one, by distance, so a chain started outside the range walks back into it
+        double log_weight(int k) const {
+            if (frontier.remaining < 0) {
+                return 0.0;
+            }
+            const int interior_mines = frontier.remaining - k;
+            if (!allowed(k)) {
+                const int distance = interior_mines < 0 ? -interior_mines : interior_mines - frontier.interior;
+                return -1e12 - distance;
+            }
+            return -std::lgamma(interior_mines + 1.0) - std::lgamma(frontier.interior - interior_mines + 1.0);
+        }
+
+        // Redraws the block of border tiles nearest the centre from its distribution given the rest of the layout
+        void update(int centre) {
+            if (++stamp == 0) {
+                std::fill(cell_mark.begin(), cell_mark.end(), 0);
+                std::fill(constraint_mark.begin(), constraint_mark.end(), 0);
+                stamp = 1;
+            }
+            block.clear();
+            block.push_back(centre);
+            cell_mark[centre] = stamp;
+            for (size_t head = 0; head < block.size() && static_cast<int>(block.size()) < block_limit; head++) {
+                for (int next : frontier.cell_neighbours[block[head]]) {
+                    if (cell_mark[next] != stamp && static_cast<int>(block.size()) < block_limit) {
+                        cell_mark[next] = stamp;
+                        block.push_back(next);
+                    }
+                }
+            }
+
+            need.clear();
+            left.clear();
+            for (int cell : block) {
+                for (int c : frontier.cell_constraints[cell]) {
+                    if (constraint_mark[c] != stamp) {
+                        constraint_mark[c] = stamp;
+                        local_of[c] = static_cast<int>(need.size());
+                        need.push_back(frontier.targets[c] - counts[c]);
+                        left.push_back(0);
+                    }
+                    need[local_of[c]] += mine[cell];
+                    left[local_of[c]]++;
+                }
+                border_mines -= mine[cell];
+            }
+
+            layouts.clear();
+            enumerate(0, 0, 0);
+
+            weights.resize(layouts.size());
+            double highest = -std::numeric_limits<double>::infinity();
+            for (size_t i = 0; i < layouts.size(); i++) {
+                weights[i] = log_weight(border_mines + layouts[i].mines);
+                highest = std::max(highest, weights[i]);
+            }
+            double total = 0.0;
+            for (double& weight : weights) {
+                weight = std::exp(weight - highest);
+                total += weight;
+            }
+            double u = std::uniform_real_distribution<double>(0.0, total)(generator);
+            size_t chosen = 0;
+            while (chosen + 1 < layouts.size() && (u -= weights[chosen]) >= 0.0) {
+                chosen++;
+            }
+
+            for (size_t i = 0; i < block.size(); i++) {
+                const int cell = block[i];
+                const uint8_t value = (layouts[chosen].mask >> i) & 1;
+                for (int c : frontier.cell_constraints[cell]) {
+                    counts[c] += value - mine[cell];
+                }
+                mine[cell] = value;
+            }
+            border_mines += layouts[chosen].mines;
+        }
+
+        // Every assignment of the block from position i on that keeps the local constraints satisfiable
+        void enumerate(size_t i, uint32_t mask, int mines) {
+            if (i == block.size()) {
+                layouts.push_back({ mask, mines });
+                return;
+            }
+            const std::vector<int>& constraints = frontier.cell_constraints[block[i]];
+            for (int value = 0; value < 2; value++) {
+                bool valid = true;
+                for (int c : constraints) {
+                    const int l = local_of[c];
+                    need[l] -= value;
+                    left[l]--;
+                    valid &= need[l] >= 0 && need[l] <= left[l];
+                }
+                if (valid) {
+                    enumerate(i + 1, mask | static_cast<uint32_t>(value) << i, mines + value);
+                }
+                for (int c : constraints) {
+                    need[local_of[c]] += value;
+                    left[local_of[c]]++;
+                }
+            }
+        }
+
+        void record(int slice) {
+            Batch& batch = batches[std::min(slice, BATCHES - 1)];
+            for (size_t i = 0; i < mine.size(); i++) {
+                batch.mines[i] += mine[i];
+            }
+            if (frontier.remaining >= 0 && frontier.interior > 0) {
+                batch.interior += static_cast<double>(frontier.remaining - border_mines) / frontier.interior;
+            }
+            batch.samples++;
+        }
+    };
+
+    // Mean over every sample and the standard error from the spread of batch means, index == mines.size() is the interior
+    void summarise(const std::vector<const Batch*>& batches, uint64_t samples, const std::vector<double>& totals,
+        size_t index, double& mean, double& error) {
+        mean = totals[index] / samples;
+        double variance = 0.0;
+        size_t used = 0;
+        for (const Batch* batch : batches) {
+            const double value = index < batch->mines.size() ? batch->mines[index] : batch->interior;
+            const double batch_mean = value / batch->samples;
+            variance += (batch_mean - mean) * (batch_mean - mean);
+            used++;
+        }
+        error = used > 1 ? std::sqrt(variance / (used - 1) / used) : 1.0;
+    }
+}
+
+SampleResult sample_frontier(const Board& board, const SamplerOptions& options) {
+    SampleResult result;
+    const Frontier frontier = build_frontier(board, options.mines);
+    if (frontier.cells.empty()) {
+        return result;
+    }
+
+    const std::shared_ptr<WorkStealingPool> pool = WorkStealingPool::shared();
+    const unsigned int chain_count = std::max(options.chains, 1u);
+    std::vector<Chain> chains;
+    chains.reserve(chain_count);
+    for (unsigned int c = 0; c < chain_count; c++) {
+        chains.emplace_back(frontier, options, options.seed * 0x9E3779B97F4A7C15ull + c);
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (options.time_cap.count() > 0) {
+        deadline = std::chrono::steady_clock::now() + options.time_cap;
+    }
+    pool->run(chains.size(), [&](size_t c) { chains[c].run(options.steps, deadline); });
+
+    // Pool every non-empty batch, the last slot holds the interior estimate
+    const size_t cells = frontier.cells.size();
+    std::vector<double> totals(cells + 1, 0.0);
+    std::vector<const Batch*> batches;
+    for (const Chain& chain : chains) {
+        result.steps += chain.get_steps();
+        for (const Batch& batch : chain.get_batches()) {
+            if (batch.samples == 0) {
+                continue;
+            }
+            batches.push_back(&batch);
+            result.samples += batch.samples;
+            for (size_t i = 0; i < cells; i++) {
+                totals[i] += batch.mines[i];
+            }
+            totals[cells] += batch.interior;
+        }
+    }
+    if (result.samples == 0) {
+        return result;
+    }
+
+    const int width = board.get_width();
+    for (size_t i = 0; i < cells; i++) {
+        CellProbability cell{ frontier.cells[i] % width, frontier.cells[i] / width, 0.0, 0.0 };
+        summarise(batches, result.samples, totals, i, cell.probability, cell.error);
+        result.border.push_back(cell);
+    }
+    if (frontier.remaining >= 0 && frontier.interior > 0) {
+        summarise(batches, result.samples, totals, cells, result.interior_probability, result.interior_error);
+    }
+    return result;
+}
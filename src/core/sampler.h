@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "board.h"
+
+// Monte Carlo estimate of the mine probabilities around the border, for frontiers too large to enumerate.
+// Each chain finds a border layout satisfying every revealed number with a depth-first search along the border, then
+// repeatedly redraws a small block of neighbouring border tiles from its exact conditional distribution, so every
+// state stays valid. A layout is weighted by the number of ways to place the remaining mines away from the border.
+// Chains run a fixed number of steps, so the same position, options and seed always give the same result.
+
+struct SamplerOptions {
+    uint64_t steps = 512;       // Block updates per chain
+    std::chrono::microseconds time_cap{ 0 }; // Optional wall time limit per call, results then depend on machine load
+    int mines = -1;             // Total mines on the board if known, weighs layouts by the tiles away from the border
+    unsigned int chains = 4;    // Chains on the shared work pool, fixed rather than per thread so results do not depend on it
+    uint64_t seed = 0;          // Chain c seeds its generator from seed and c
+    int block_size = 10;        // Border tiles redrawn together (1 to 16), up to 2^block_size layouts enumerated per step
+};
+
+struct CellProbability {
+    int x;
+    int y;
+    double probability;
+    double error; // Standard error from batch means across every chain
+};
+
+struct SampleResult {
+    std::vector<CellProbability> border;
+    double interior_probability = -1.0; // Any tile away from the border, -1 without a mine count or interior tiles
+    double interior_error = 0.0;
+    uint64_t samples = 0; // Layouts satisfying every constraint
+    uint64_t steps = 0;   // Block updates over all chains
+};
+
+SampleResult sample_frontier(const Board& board, const SamplerOptions& options);
@@ -0,0 +1,80 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <thread>
+
+#include "scheduler.h"
+
+constexpr int STEPS_PER_TURN = 16;
+
+std::chrono::nanoseconds thread_cpu_time() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    auto to_100ns = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return std::chrono::nanoseconds((to_100ns(kernel) + to_100ns(user)) * 100);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::nanoseconds(static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec);
+#endif
+}
+
+void CoroutineScheduler::spawn(SolveTask task, Completion done) {
+    size_t slot;
+    if (free_slots.empty()) {
+        slot = tasks.size();
+        tasks.emplace_back();
+    }
+    else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    tasks[slot] = { std::move(done), {}, std::move(task) };
+    ready.push_back(slot);
+}
+
+void CoroutineScheduler::run() {
+    using clock = std::chrono::steady_clock;
+    while (!ready.empty() || !sleeping.empty()) {
+        clock::time_point now = clock::now();
+        while (!sleeping.empty() && sleeping.top().first <= now) {
+            ready.push_back(sleeping.top().second);
+            sleeping.pop();
+        }
+        if (ready.empty()) {
+            std::this_thread::sleep_until(sleeping.top().first);
+            continue;
+        }
+
+        const size_t slot = ready.front();
+        ready.pop_front();
+        const std::chrono::nanoseconds cpu_start = thread_cpu_time();
+        // A task that only yields keeps the thread for a few steps, its board stays in cache
+        for (int step = 0; step < STEPS_PER_TURN && !tasks[slot].task.done() && tasks[slot].task.wake_time() <= now; step++) {
+            tasks[slot].task.resume();
+        }
+        const clock::time_point after = clock::now();
+        tasks[slot].run_time += thread_cpu_time() - cpu_start;
+
+        if (tasks[slot].task.done()) {
+            // Free the slot first, the completion may spawn into it
+            Entry finished = std::move(tasks[slot]);
+            tasks[slot] = {};
+            free_slots.push_back(slot);
+            finished.done(finished.task.result(), finished.run_time);
+        }
+        else if (tasks[slot].task.wake_time() > after) {
+            sleeping.push({ tasks[slot].task.wake_time(), slot });
+        }
+        else {
+            ready.push_back(slot);
+        }
+    }
+}
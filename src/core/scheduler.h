@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "solve_task.h"
+
+// CPU time consumed by the calling thread
+std::chrono::nanoseconds thread_cpu_time();
+
+// Single-threaded round robin over coroutine solves. Runnable tasks take turns one step at a time, sleeping tasks
+// wait in a timer queue, and the thread only blocks when every task is asleep, so thousands of games share one
+// thread and their move delays overlap.
+class CoroutineScheduler {
+public:
+    // Called once a task finishes, with the thread CPU time spent running its steps. May spawn further tasks.
+    using Completion = std::function<void(SolverResult result, std::chrono::nanoseconds run_time)>;
+
+    void spawn(SolveTask task, Completion done);
+    void run(); // Returns once every task, including ones spawned while running, has finished
+    size_t active() const { return tasks.size() - free_slots.size(); }
+
+private:
+    // The completion may own the solver the task runs, so the task is declared last and destroyed first
+    struct Entry {
+        Completion done;
+        std::chrono::nanoseconds run_time{};
+        SolveTask task;
+    };
+    using Timer = std::pair<std::chrono::steady_clock::time_point, size_t>;
+
+    std::vector<Entry> tasks; // Slots are reused once their task finishes
+    std::vector<size_t> free_slots;
+    std::deque<size_t> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> sleeping;
+};
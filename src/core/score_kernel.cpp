@@ -0,0 +1,178 @@
+#include <stdexcept>
+#include "score_kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MSX_X86_64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    // Sum of the 8 tiles around every position in [first, last). Both bounds keep a full row of margin.
+    void sum_around_scalar(const int8_t* in, int8_t* out, int stride, int first, int last) {
+        for (int i = first; i < last; i++) {
+            out[i] = static_cast<int8_t>(in[i - stride - 1] + in[i - stride] + in[i - stride + 1] + in[i - 1] +
+                in[i + 1] + in[i + stride - 1] + in[i + stride] + in[i + stride + 1]);
+        }
+    }
+
+    // Same neighbour order as Board::neighbours, so the additions round exactly like the reference
+    void sum_chance_scalar(const double* in, double* out, int stride, int first, int last) {
+        for (int i = first; i < last; i++) {
+            double sum = 0.0;
+            sum += in[i - stride - 1];
+            sum += in[i - stride];
+            sum += in[i - stride + 1];
+            sum += in[i - 1];
+            sum += in[i + 1];
+            sum += in[i + stride - 1];
+            sum += in[i + stride];
+            sum += in[i + stride + 1];
+            out[i] = sum;
+        }
+    }
+
+#ifdef MSX_X86_64
+    AVX2_TARGET inline __m256i load_bytes(const int8_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    AVX2_TARGET void sum_around_avx2(const int8_t* in, int8_t* out, int stride, int first, int last) {
+        int i = first;
+        for (; i + 32 <= last; i += 32) {
+            const int8_t* p = in + i;
+            __m256i sum = _mm256_add_epi8(load_bytes(p - stride - 1), load_bytes(p - stride));
+            sum = _mm256_add_epi8(sum, load_bytes(p - stride + 1));
+            sum = _mm256_add_epi8(sum, load_bytes(p - 1));
+            sum = _mm256_add_epi8(sum, load_bytes(p + 1));
+            sum = _mm256_add_epi8(sum, load_bytes(p + stride - 1));
+            sum = _mm256_add_epi8(sum, load_bytes(p + stride));
+            sum = _mm256_add_epi8(sum, load_bytes(p + stride + 1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        }
+        sum_around_scalar(in, out, stride, i, last);
+    }
+
+    // Four tiles per vector, each lane adds its neighbours in the same order as the scalar loop
+    AVX2_TARGET void sum_chance_avx2(const double* in, double* out, int stride, int first, int last) {
+        int i = first;
+        for (; i + 4 <= last; i += 4) {
+            __m256d sum = _mm256_setzero_pd();
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i - stride - 1));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i - stride));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i - stride + 1));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i - 1));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i + 1));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i + stride - 1));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i + stride));
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(in + i + stride + 1));
+            _mm256_storeu_pd(out + i, sum);
+        }
+        sum_chance_scalar(in, out, stride, i, last);
+    }
+#endif
+}
+
+bool avx2_supported() {
+#if defined(MSX_X86_64) && defined(_MSC_VER) && !defined(__clang__)
+    // AVX and OSXSAVE in the CPU, the OS saving the XMM and YMM registers, then AVX2 itself
+    int info[4];
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(MSX_X86_64)
+    // The compiler runtime checks the CPUID bits and XGETBV the same way
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void score_board(const Board& board, ScoreScratch& scratch, std::vector<TileScore>& scores, ScoreKernel kernel) {
+    static const bool has_avx2 = avx2_supported();
+    if (kernel == AVX2_KERNEL && !has_avx2) {
+        throw std::runtime_error("AVX2 score kernel is not available on this machine");
+    }
+    const bool use_avx2 = kernel == AVX2_KERNEL || (kernel == AUTO_KERNEL && has_avx2);
+
+    const std::vector<Tile>& tiles = board.get_all_tiles();
+    const int width = board.get_width();
+    const int height = board.get_height();
+    const int stride = width + 2;
+    const size_t size = static_cast<size_t>(stride) * (height + 2);
+    scratch.stride = stride;
+    for (std::vector<int8_t>* plane : { &scratch.value, &scratch.undiscovered, &scratch.mine, &scratch.unknown, &scratch.valid,
+        &scratch.undiscovered_around, &scratch.mines_around, &scratch.unknown_around, &scratch.valid_around }) {
+        plane->assign(size, 0);
+    }
+    scratch.chance.assign(size, 0.0);
+    scratch.chance_sum.assign(size, 0.0);
+    scores.clear();
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const int value = tiles[y * width + x].value;
+            const int p = (y + 1) * stride + x + 1;
+            scratch.value[p] = static_cast<int8_t>(value > 0 ? value : 0);
+            scratch.undiscovered[p] = value == UNDISCOVERED;
+            scratch.mine[p] = value == MINE;
+            scratch.unknown[p] = value == UNKNOWN;
+        }
+    }
+
+    // Every pass covers the rows of the board, padding columns included, and leaves the outer padding at zero
+    const int first = stride + 1;
+    const int last = stride * (height + 1) - 1;
+    auto sum_around = [&](const std::vector<int8_t>& in, std::vector<int8_t>& out) {
+#ifdef MSX_X86_64
+        if (use_avx2) {
+            sum_around_avx2(in.data(), out.data(), stride, first, last);
+            return;
+        }
+#endif
+        sum_around_scalar(in.data(), out.data(), stride, first, last);
+    };
+    sum_around(scratch.undiscovered, scratch.undiscovered_around);
+    sum_around(scratch.mine, scratch.mines_around);
+    sum_around(scratch.unknown, scratch.unknown_around);
+
+    // Local mine chance of every numbered tile that has undiscovered neighbours and no unrecognised ones
+    for (int p = first; p < last; p++) {
+        if (scratch.value[p] > 0 && scratch.unknown_around[p] == 0 && scratch.undiscovered_around[p] > 0) {
+            scratch.valid[p] = 1;
+            scratch.chance[p] = static_cast<double>(scratch.value[p] - scratch.mines_around[p]) / scratch.undiscovered_around[p];
+        }
+    }
+
+    sum_around(scratch.valid, scratch.valid_around);
+#ifdef MSX_X86_64
+    if (use_avx2) {
+        sum_chance_avx2(scratch.chance.data(), scratch.chance_sum.data(), stride, first, last);
+    }
+    else
+#endif
+    {
+        sum_chance_scalar(scratch.chance.data(), scratch.chance_sum.data(), stride, first, last);
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const int p = (y + 1) * stride + x + 1;
+            const int valid_neighbors = scratch.valid_around[p];
+            if (!scratch.undiscovered[p] || valid_neighbors == 0) {
+                continue;
+            }
+            const double avg_probability = scratch.chance_sum[p] / valid_neighbors;
+            const double neighbor_bonus = 1.0 + (valid_neighbors / 12.0);
+            scores.push_back({ x, y, avg_probability, avg_probability / neighbor_bonus, valid_neighbors });
+        }
+    }
+}
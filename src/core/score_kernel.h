@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "board.h"
+#include "frontier.h"
+
+// Guess scores of every undiscovered tile on the board in a few passes over dense planes, instead of walking the
+// neighbours of the neighbours of each tile. The planes carry a one tile border of zeros so every pass is a straight
+// run over memory. Scores match analyze_component bit for bit, in board order.
+
+enum ScoreKernel {
+    AUTO_KERNEL,   // AVX2 when the CPU supports it, scalar otherwise
+    SCALAR_KERNEL,
+    AVX2_KERNEL    // Throws when the CPU or the build lacks AVX2
+};
+
+// Caller-owned planes, reused between calls. Indexed (y + 1) * stride + x + 1
+struct ScoreScratch {
+    int stride = 0;
+    std::vector<int8_t> value;        // Revealed number, 0 for anything else
+    std::vector<int8_t> undiscovered; // 1 for undiscovered tiles
+    std::vector<int8_t> mine;         // 1 for flagged tiles
+    std::vector<int8_t> unknown;      // 1 for unrecognised tiles
+    std::vector<int8_t> valid;        // 1 for numbered tiles whose local mine chance counts
+    std::vector<int8_t> undiscovered_around;
+    std::vector<int8_t> mines_around;
+    std::vector<int8_t> unknown_around;
+    std::vector<int8_t> valid_around;
+    std::vector<double> chance;       // Remaining mines over undiscovered neighbours of valid tiles, 0 elsewhere
+    std::vector<double> chance_sum;   // Sum of the neighbours' chances in row-major neighbour order
+};
+
+bool avx2_supported();
+void score_board(const Board& board, ScoreScratch& scratch, std::vector<TileScore>& scores, ScoreKernel kernel = AUTO_KERNEL);
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+enum SolverResult {
+    SUCCESS,
+    FAILURE,
+    STUCK
+};
+
+// Handle to a solve running as a C++20 coroutine. It starts suspended and runs one step per resume, where a step
+// ends after a solver cycle or when the solve would wait on the game, see CoroutineScheduler.
+class SolveTask {
+public:
+    struct promise_type {
+        SolverResult result = STUCK;
+        std::chrono::steady_clock::time_point wake{}; // Not resumed before this
+        std::exception_ptr exception;
+
+        SolveTask get_return_object() { return SolveTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(SolverResult r) { result = r; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    // Suspends until the given time, other tasks run in the meantime
+    struct Sleep {
+        std::chrono::steady_clock::time_point until;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> h) const noexcept { h.promise().wake = until; }
+        void await_resume() const noexcept {}
+    };
+
+    static std::suspend_always yield() { return {}; }
+    static Sleep sleep_for(std::chrono::milliseconds delay) { return { std::chrono::steady_clock::now() + delay }; }
+
+    SolveTask() = default;
+    SolveTask(SolveTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    SolveTask& operator=(SolveTask&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    SolveTask(const SolveTask&) = delete;
+    SolveTask& operator=(const SolveTask&) = delete;
+    ~SolveTask() { destroy(); }
+
+    // Runs the next step, rethrowing anything the solve threw
+    void resume() {
+        handle.resume();
+        if (handle.promise().exception) {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+    bool done() const { return !handle || handle.done(); }
+    SolverResult result() const { return handle.promise().result; }
+    std::chrono::steady_clock::time_point wake_time() const { return handle.promise().wake; }
+
+private:
+    explicit SolveTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    void destroy() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+    std::coroutine_handle<promise_type> handle;
+};
@@ -1,43 +1,192 @@
 #pragma once
+#include <algorithm>
 #include <memory>
+#include <set>
+#include <string>
+#include <thread>
 #include "game.h"
+#include "move.h"
+#include "moves.h"
+#include "frontier.h"
+#include "strategy.h"
+#include "solve_task.h"
 #include <utils/terminal.h>
+#include <utils/trace.h>
+#include <utils/alloc_tracker.h>
 
-enum Action {
-    CLICK_ACTION,
-    FLAG_ACTION
+// Whether the solver loop waits for the game's move delay between cycles
+enum Pacing {
+    PACED,
+    UNPACED
 };
 
-enum SolverResult {
-    SUCCESS,
-    FAILURE,
-    STUCK
+// Counters collected over a single solve
+struct SolverStats {
+    int cycles = 0;
+    int moves = 0;
+    int guesses = 0;
+    int propagated = 0; // Moves deduced within a cycle from the flags it had just placed
+    int inputs = 0;     // Clicks, flags and chords sent to the game; below moves when chords replace clicks
+    size_t cache_hits = 0;
+    size_t cache_misses = 0;
+    size_t cache_evictions = 0;
+    std::vector<StageStats> stages; // In the order of the strategy's stages
 };
 
-struct Move {
-    Action action;
-    int x;
-    int y;
-
-    // For set operations
-    bool operator<(const Move& other) const {
-        if (action != other.action)
-            return action < other.action;
-        if (x != other.x)
-            return x < other.x;
-        return y < other.y;
-    }
-};
-
-class Solver {
+// Move generation and bookkeeping shared by every game type
+class SolverBase {
 public:
-    Solver(std::shared_ptr<Game> g, bool v);
-    SolverResult solve();
+    SolverStats get_stats() const;
+    void set_strategy(const Strategy& s);
 
-private:
-    std::shared_ptr<Game> game;
+protected:
+    SolverBase(std::shared_ptr<Board> board, int mines, bool v);
     std::shared_ptr<BoardDisplay> display;
+    ComponentCache component_cache;
+    SolverStats stats;
+    const Strategy* strategy = nullptr;
     int move_number = 0;
+    int mine_count;
+    std::set<Move> get_moves(const Board& board, bool guess);
     void update_board();
 	void print_move(int x, int y, Action action);
-};
\ No newline at end of file
+};
+
+// Solver loop over a game type. Solver<Game> calls the game through its virtual interface, a concrete final
+// game type such as Virtual has its calls resolved statically, and UNPACED drops the move delay sleep entirely
+template<typename GameT = Game, Pacing P = PACED>
+class Solver : public SolverBase {
+public:
+    Solver(std::shared_ptr<GameT> g, bool v) : SolverBase(g->get_board(), g->get_mine_count(), v), game(std::move(g)) {}
+    SolverResult solve();
+
+    // Same solve as a coroutine that suspends after every cycle and instead of sleeping the move delay.
+    // The solver must outlive the task.
+    SolveTask solve_async();
+
+private:
+    std::shared_ptr<GameT> game;
+    int failed_cycles = 0;
+    bool guessing = true;
+    bool cycle(); // False when stuck
+    void execute(const std::set<Move>& moves);
+};
+
+template<typename GameT, Pacing P>
+bool Solver<GameT, P>::cycle() {
+	const int failed_cycle_threshould = game->get_failed_cycle_threshold(); // Number of failed cycles before guessing
+	const std::shared_ptr<Board> board = game->get_board();
+
+    TRACE_SPAN("solver.cycle");
+    stats.cycles++;
+    update_board();
+    std::set<Move> moves;
+    {
+        TRACE_SPAN("solver.get_moves");
+        ALLOC_PHASE(GET_MOVES_PHASE);
+        moves = get_moves(*board, guessing);
+    }
+    if (moves.empty() && guessing) {
+        return false;
+    }
+    else if (moves.empty() && ++failed_cycles >= failed_cycle_threshould) {
+        guessing = true;
+        failed_cycles = 0;
+    }
+    else {
+        guessing = false;
+        execute(moves);
+
+        // Flags land on the board straight away, so deduce again from them without waiting for the game to update.
+        // Clicks stay undiscovered until then and would be deduced again, so the ones already issued are skipped
+        std::set<Move> issued = moves;
+        auto placed_flag = [](const std::set<Move>& batch) {
+            return std::any_of(batch.begin(), batch.end(), [](const Move& move) { return move.action == FLAG_ACTION; });
+        };
+        while (placed_flag(moves) && game->status() == IN_PROGRESS) {
+            {
+                TRACE_SPAN("solver.get_moves");
+                ALLOC_PHASE(GET_MOVES_PHASE);
+                moves = get_moves(*board, false);
+            }
+            for (auto it = moves.begin(); it != moves.end();) {
+                it = issued.count(*it) ? moves.erase(it) : std::next(it);
+            }
+            if (moves.empty()) {
+                break;
+            }
+            stats.propagated += static_cast<int>(moves.size());
+            issued.insert(moves.begin(), moves.end());
+            execute(moves);
+        }
+    }
+    return true;
+}
+
+template<typename GameT, Pacing P>
+void Solver<GameT, P>::execute(const std::set<Move>& moves) {
+    TRACE_SPAN("solver.execute_moves");
+    ALLOC_PHASE(EXECUTE_MOVES_PHASE);
+    const std::shared_ptr<Board> board = game->get_board();
+    stats.moves += static_cast<int>(moves.size());
+    const std::set<Move> inputs = game->supports_chord() ? chord_moves(*board, moves) : moves;
+    stats.inputs += static_cast<int>(inputs.size());
+    for (Move move : inputs) {
+		print_move(move.x, move.y, move.action);
+        if (move.action == FLAG_ACTION) {
+            board->set_tile(move.x, move.y, MINE);
+            ALLOC_PHASE(GAME_FLAG_PHASE);
+            game->flag(move.x, move.y); // Commented out for now
+        }
+        else if (move.action == CLICK_ACTION) {
+            ALLOC_PHASE(GAME_CLICK_PHASE);
+            game->click(move.x, move.y);
+        }
+        else if (move.action == CHORD_ACTION) {
+            ALLOC_PHASE(GAME_CLICK_PHASE);
+            game->chord(move.x, move.y);
+        }
+    }
+}
+
+template<typename GameT, Pacing P>
+SolverResult Solver<GameT, P>::solve() {
+    while (game->status() == IN_PROGRESS) {
+        if (!cycle()) {
+            return STUCK;
+        }
+        if constexpr (P == PACED) {
+            TRACE_SPAN("solver.move_delay");
+            std::this_thread::sleep_for(game->get_move_delay());
+        }
+        TRACE_SPAN("game.update");
+        ALLOC_PHASE(GAME_UPDATE_PHASE);
+        game->update();
+    }
+
+	update_board();
+
+	return game->status() == WON ? SUCCESS : FAILURE;
+}
+
+template<typename GameT, Pacing P>
+SolveTask Solver<GameT, P>::solve_async() {
+    while (game->status() == IN_PROGRESS) {
+        if (!cycle()) {
+            co_return STUCK;
+        }
+        if constexpr (P == PACED) {
+            co_await SolveTask::sleep_for(game->get_move_delay());
+        }
+        else {
+            co_await SolveTask::yield();
+        }
+        TRACE_SPAN("game.update");
+        ALLOC_PHASE(GAME_UPDATE_PHASE);
+        game->update();
+    }
+
+	update_board();
+
+	co_return game->status() == WON ? SUCCESS : FAILURE;
+}
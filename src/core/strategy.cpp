@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include "moves.h"
+#include "sampler.h"
+#include "score_kernel.h"
+#include "work_pool.h"
+#include "utils/trace.h"
+
+#include "strategy.h"
+
+// Certain moves and guess scores of every component, reusing cached analyses
+static std::set<Move> cached_basic_stage(StageContext& context) {
+    std::vector<FrontierComponent> components;
+    {
+        TRACE_SPAN("solver.split_frontier");
+        components = split_frontier(context.board);
+    }
+
+    std::set<Move> moves;
+    for (const FrontierComponent& component : components) {
+        const ComponentAnalysis* analysis = context.cache.find(component);
+        if (analysis == nullptr) {
+            TRACE_SPAN("solver.analyze_component");
+            analysis = &context.cache.insert(component, analyze_component(context.board, component));
+        }
+        moves.insert(analysis->moves.begin(), analysis->moves.end());
+    }
+    return moves;
+}
+
+// Same as the cached stage but analyses every component again
+static std::set<Move> uncached_basic_stage(StageContext& context) {
+    std::set<Move> moves;
+    for (const FrontierComponent& component : split_frontier(context.board)) {
+        ComponentAnalysis analysis = analyze_component(context.board, component);
+        moves.insert(analysis.moves.begin(), analysis.moves.end());
+    }
+    return moves;
+}
+
+// Cached stage with the missed components analysed on the shared work-stealing pool, merged in component order
+static std::set<Move> parallel_basic_stage(StageContext& context) {
+    std::vector<FrontierComponent> components;
+    {
+        TRACE_SPAN("solver.split_frontier");
+        components = split_frontier(context.board);
+    }
+
+    // The cache is not thread safe, so lookups and inserts stay on this thread
+    std::vector<const ComponentAnalysis*> analyses(components.size(), nullptr);
+    std::vector<size_t> missed;
+    for (size_t i = 0; i < components.size(); i++) {
+        analyses[i] = context.cache.find(components[i]);
+        if (analyses[i] == nullptr) {
+            missed.push_back(i);
+        }
+    }
+
+    std::vector<ComponentAnalysis> fresh(missed.size());
+    {
+        TRACE_SPAN("solver.analyze_components");
+        WorkStealingPool::shared()->run(missed.size(), [&](size_t i) {
+            analyze_component(context.board, components[missed[i]], fresh[i]);
+        });
+    }
+    for (size_t i = 0; i < missed.size(); i++) {
+        analyses[missed[i]] = &fresh[i];
+    }
+
+    std::set<Move> moves;
+    for (const ComponentAnalysis* analysis : analyses) {
+        moves.insert(analysis->moves.begin(), analysis->moves.end());
+    }
+
+    // Inserting can evict entries found above, so only once they have been merged
+    for (size_t i = 0; i < missed.size(); i++) {
+        context.cache.insert(components[missed[i]], std::move(fresh[i]));
+    }
+    return moves;
+}
+
+static std::set<Move> first_stage(StageContext& context) {
+    return context.board.discovered_count() == 0 ? first_move(context.board) : std::set<Move>{};
+}
+
+// Guess scores of the whole board from the plane kernel, the same scores the component analyses would give
+static std::vector<TileScore>& board_scores(StageContext& context) {
+    thread_local ScoreScratch scratch;
+    score_board(context.board, scratch, context.scores);
+    return context.scores;
+}
+
+static std::set<Move> guess_stage(StageContext& context) {
+    TRACE_SPAN("solver.guess_move");
+    return guess_move(context.board, board_scores(context));
+}
+
+static std::set<Move> chance_guess_stage(StageContext& context) {
+    TRACE_SPAN("solver.guess_move");
+    return guess_move(context.board, board_scores(context), false);
+}
+
+// Clicks the tile with the lowest sampled mine probability, a tile away from the border when that is safer.
+// The chains are seeded from the position, so a replayed or paired game makes the same guess.
+// Falls back to the score guess when no valid layout was sampled
+static std::set<Move> sampled_guess_stage(StageContext& context) {
+    SampleResult result;
+    {
+        TRACE_SPAN("solver.sample_frontier");
+        SamplerOptions options;
+        options.mines = context.mines;
+        options.seed = 0xcbf29ce484222325ull;
+        for (const Tile& tile : context.board.get_all_tiles()) {
+            options.seed = (options.seed ^ static_cast<uint64_t>(tile.value + 4)) * 0x100000001b3ull;
+        }
+        result = sample_frontier(context.board, options);
+    }
+    if (result.samples == 0) {
+        return guess_move(context.board, board_scores(context));
+    }
+
+    const CellProbability* best = &result.border.front();
+    for (const CellProbability& cell : result.border) {
+        if (cell.probability < best->probability) {
+            best = &cell;
+        }
+    }
+    if (result.interior_probability >= 0.0 && result.interior_probability < best->probability) {
+        const Board& board = context.board;
+        for (const Tile& tile : board.get_all_tiles()) {
+            if (tile.value != UNDISCOVERED) {
+                continue;
+            }
+            const NeighbourList neighbours = board.neighbours(board.to_index(tile.x, tile.y));
+            if (std::none_of(neighbours.begin(), neighbours.end(), [&](int n) { return board.get_all_tiles()[n].value >= 0; })) {
+                return { { CLICK_ACTION, tile.x, tile.y } };
+            }
+        }
+    }
+    return { { CLICK_ACTION, best->x, best->y } };
+}
+
+namespace {
+    struct Registry {
+        std::map<std::string, std::unique_ptr<const Stage>> stages;
+        std::map<std::string, Strategy> strategies;
+        std::mutex mutex;
+
+        Registry() {
+            add_stage({ "first", OPENING_STAGE, first_stage });
+            add_stage({ "basic", CERTAIN_STAGE, cached_basic_stage });
+            add_stage({ "basic-uncached", CERTAIN_STAGE, uncached_basic_stage });
+            add_stage({ "basic-parallel", CERTAIN_STAGE, parallel_basic_stage });
+            add_stage({ "guess", GUESS_STAGE, guess_stage });
+            add_stage({ "guess-chance", GUESS_STAGE, chance_guess_stage });
+            add_stage({ "guess-sampled", GUESS_STAGE, sampled_guess_stage });
+
+            add_strategy(DEFAULT_STRATEGY_NAME, "certain moves, then guess by neighbour-weighted score", { "first", "basic", "guess" });
+            add_strategy("chance", "certain moves, then guess by plain mine chance", { "first", "basic", "guess-chance" });
+            add_strategy("uncached", "default without the component cache", { "first", "basic-uncached", "guess" });
+            add_strategy("parallel", "default with components analysed on every core", { "first", "basic-parallel", "guess" });
+            add_strategy("sampled", "certain moves, then guess by sampled mine probability", { "first", "basic", "guess-sampled" });
+        }
+
+        // Solvers read stages and strategies without the lock, so registered entries are never changed or freed
+        void add_stage(const Stage& stage) {
+            if (!stages.emplace(stage.name, std::make_unique<const Stage>(stage)).second) {
+                throw std::runtime_error("Stage " + stage.name + " is already registered");
+            }
+        }
+
+        void add_strategy(const std::string& name, const std::string& description, const std::vector<std::string>& stage_names) {
+            if (strategies.count(name)) {
+                throw std::runtime_error("Strategy " + name + " is already registered");
+            }
+            Strategy strategy{ name, description, {} };
+            for (const std::string& stage_name : stage_names) {
+                auto it = stages.find(stage_name);
+                if (it == stages.end()) {
+                    throw std::runtime_error("Unknown stage " + stage_name + " in strategy " + name);
+                }
+                strategy.stages.push_back(it->second.get());
+            }
+            strategies.emplace(name, std::move(strategy));
+        }
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+}
+
+void register_stage(const Stage& stage) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.add_stage(stage);
+}
+
+void register_strategy(const std::string& name, const std::string& description, const std::vector<std::string>& stage_names) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.add_strategy(name, description, stage_names);
+}
+
+const Strategy& find_strategy(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = r.strategies.find(name);
+    if (it == r.strategies.end()) {
+        std::string known;
+        for (const auto& [strategy_name, strategy] : r.strategies) {
+            known += (known.empty() ? "" : ", ") + strategy_name;
+        }
+        throw std::runtime_error("Unknown strategy: " + name + " (expected one of " + known + ")");
+    }
+    return it->second;
+}
+
+std::vector<const Strategy*> registered_strategies() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<const Strategy*> result;
+    for (const auto& [name, strategy] : r.strategies) {
+        result.push_back(&strategy);
+    }
+    return result;
+}
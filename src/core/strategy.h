@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "move.h"
+#include "frontier.h"
+
+// Named move generation stages and the strategies built from them. A strategy runs its stages in order
+// and takes the moves of the first stage that finds any, so alternative engines plug in without touching Solver.
+
+enum StageKind {
+    OPENING_STAGE, // Only runs while guessing is allowed, not counted as a guess
+    CERTAIN_STAGE, // Always runs
+    GUESS_STAGE    // Only runs while guessing is allowed
+};
+
+// State shared by the stages of one get_moves call
+struct StageContext {
+    const Board& board;
+    ComponentCache& cache;
+    int mines;                     // Total mines on the board, -1 if unknown
+    std::vector<TileScore> scores; // Guess scores, filled by the guess stages from the score kernel
+};
+
+struct Stage {
+    std::string name;
+    StageKind kind;
+    std::set<Move> (*generate)(StageContext& context);
+};
+
+struct Strategy {
+    std::string name;
+    std::string description;
+    std::vector<const Stage*> stages;
+};
+
+// Per solve counters of a single stage
+struct StageStats {
+    std::string name;
+    size_t calls = 0;
+    size_t hits = 0; // Calls that produced moves
+    std::chrono::nanoseconds time{};
+};
+
+// Registers a stage or strategy, throwing if the name is taken; registered entries never change, so solvers can hold
+// pointers to them. Strategies refer to stages by name.
+void register_stage(const Stage& stage);
+void register_strategy(const std::string& name, const std::string& description, const std::vector<std::string>& stage_names);
+
+// Throws on unknown names
+const Strategy& find_strategy(const std::string& name);
+std::vector<const Strategy*> registered_strategies();
+
+constexpr const char* DEFAULT_STRATEGY_NAME = "default";
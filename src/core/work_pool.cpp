@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <utility>
+#include "work_pool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned int threads) {
+    threads = std::max(threads, 1u);
+    for (unsigned int i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned int i = 1; i < threads; i++) {
+        workers.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t)>& task) {
+    std::unique_lock<std::mutex> run_lock(run_mutex, std::try_to_lock);
+    if (!run_lock.owns_lock() || workers.empty() || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // Deal the tasks out round robin, stealing evens out the rest
+    for (size_t i = 0; i < count; i++) {
+        Queue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(i);
+    }
+    remaining = count;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        current = &task;
+        phase = alloc_tracker::current_phase();
+        generation++;
+    }
+    wake.notify_all();
+
+    work(0, task);
+
+    // Workers that wake up after this see no loop and go back to sleep
+    std::unique_lock<std::mutex> lock(state_mutex);
+    finished.wait(lock, [&] { return remaining == 0 && active == 0; });
+    current = nullptr;
+    if constexpr (alloc_tracker::ENABLED) {
+        alloc_tracker::add_thread_stats(std::exchange(worker_memory, alloc_tracker::Stats{}));
+    }
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+bool WorkStealingPool::next_task(unsigned int self, size_t& task) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Queue& victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::complete(size_t tasks) {
+    if ((remaining -= tasks) == 0) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        finished.notify_all();
+    }
+}
+
+// Keeps the first exception and empties every queue, so the loop ends once the calls already running return
+void WorkStealingPool::fail(std::exception_ptr exception) {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!error) {
+            error = exception;
+        }
+    }
+    size_t dropped = 0;
+    for (const std::unique_ptr<Queue>& queue : queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        dropped += queue->tasks.size();
+        queue->tasks.clear();
+    }
+    if (dropped > 0) {
+        complete(dropped);
+    }
+}
+
+void WorkStealingPool::work(unsigned int self, const std::function<void(size_t)>& task) {
+    size_t index;
+    while (next_task(self, index)) {
+        try {
+            task(index);
+        }
+        catch (...) {
+            fail(std::current_exception());
+        }
+        complete(1);
+    }
+}
+
+void WorkStealingPool::worker_loop(unsigned int self) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(state_mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        if (current == nullptr) {
+            continue;
+        }
+
+        const std::function<void(size_t)>& task = *current;
+        const alloc_tracker::Phase task_phase = phase;
+        active++;
+        lock.unlock();
+        if constexpr (alloc_tracker::ENABLED) {
+            // Counted on this thread in the caller's phase, then handed to run for the caller's counters
+            alloc_tracker::reset_thread_stats();
+            {
+                alloc_tracker::PhaseScope scope(task_phase);
+                work(self, task);
+            }
+            const alloc_tracker::Stats memory = alloc_tracker::thread_stats();
+            lock.lock();
+            alloc_tracker::merge(worker_memory, memory);
+        }
+        else {
+            work(self, task);
+            lock.lock();
+        }
+        if (--active == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+namespace {
+    std::mutex shared_mutex;
+    std::shared_ptr<WorkStealingPool> shared_pool;
+}
+
+std::shared_ptr<WorkStealingPool> WorkStealingPool::shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared_pool) {
+        shared_pool = std::make_shared<WorkStealingPool>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    return shared_pool;
+}
+
+void WorkStealingPool::set_shared_threads(unsigned int threads) {
+    std::shared_ptr<WorkStealingPool> pool = std::make_shared<WorkStealingPool>(threads);
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    shared_pool.swap(pool);
+    // The old pool is released after the lock, and only joins its workers once its last user is done with it
+}
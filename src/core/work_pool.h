@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utils/alloc_tracker.h"
+
+// Fork-join thread pool for short parallel loops. Every participant has its own task queue, takes work from
+// the back of it and steals from the front of the others once it runs dry, so uneven tasks still balance.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned int threads); // Total participants including the calling thread
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(queues.size()); }
+
+    // Calls task(i) for every i in [0, count) and returns once all calls are done. The caller works too.
+    // A pool runs one loop at a time, a concurrent caller runs its loop on its own thread instead.
+    // If a call throws, the tasks not yet started are dropped and the first exception is rethrown here.
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+    // Pool used by the solver stages, sized to the hardware until changed. Resizing swaps in a new pool, callers keep
+    // the one they were handed alive until they let go of it
+    static std::shared_ptr<WorkStealingPool> shared();
+    static void set_shared_threads(unsigned int threads);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // Queue 0 belongs to the calling thread
+    std::vector<std::thread> workers;
+    std::mutex run_mutex;
+
+    // Hand-off between run and the workers
+    std::mutex state_mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* current = nullptr;
+    uint64_t generation = 0;
+    unsigned int active = 0; // Workers inside the current loop
+    bool stopping = false;
+    std::atomic<size_t> remaining{ 0 };
+    std::exception_ptr error; // First exception thrown by the current loop
+    alloc_tracker::Phase phase = alloc_tracker::OTHER_PHASE; // Caller's phase, the workers count their allocations in it
+    alloc_tracker::Stats worker_memory{};                     // Workers' allocations, added to the caller's counters
+
+    bool next_task(unsigned int self, size_t& task);
+    void complete(size_t tasks);
+    void fail(std::exception_ptr exception);
+    void work(unsigned int self, const std::function<void(size_t)>& task);
+    void worker_loop(unsigned int self);
+};
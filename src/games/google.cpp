@@ -1,8 +1,10 @@
 #include <cmath>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <iostream>
 #include "utils/util.h"
+#include "utils/trace.h"
 #include "google.h"
 
 // Generates our 81 sample points for tile detection
@@ -29,24 +31,38 @@ Google::Google(const Position& pos, const Dimension& board_dim, const Dimension&
     , box_dimensions(box_dim)
     , screen(pos, board_dim)
 {
+    // The results overlay is drawn over the middle of the board, sample it every half tile
+    const uint32_t step_x = std::max<uint32_t>(box_dim.width / 2, 1);
+    const uint32_t step_y = std::max<uint32_t>(box_dim.height / 2, 1);
+    for (uint32_t y = board_dim.height / 4; y < board_dim.height * 3 / 4; y += step_y) {
+        for (uint32_t x = board_dim.width / 4; x < board_dim.width * 3 / 4; x += step_x) {
+            results_samples.emplace_back(x, y);
+        }
+    }
     update();
 }
 
+bool Google::results_visible() const {
+    for (const Position& sample : results_samples) {
+        if (color_in_range(screen.get_pixel(sample.x, sample.y), RESULTS)) {
+            return true;
+        }
+    }
+
+    // Only scan the whole screenshot when the board stopped looking like a board
+    return unknown_tiles > 0 && screen.contains_color(RESULTS, 10);
+}
+
 // Assumes the board's screenshot has already been taken
 Status Google::status() {
+    TRACE_SPAN("google.status");
     // Check win condition
-    std::vector<Tile> undiscovered = board->get_undiscovered_tiles();
-    if (undiscovered.empty()) {
+    if (board->undiscovered_count() == 0) {
         return WON;
     }
 
     // Check for game over condition
-    for (Screen::PixelIterator it = screen.begin(); it.position() <= it.end(); it.next()) {
-        if (color_in_range(it.pixel(), RESULTS)) {
-            return LOST;
-        }
-    }
-    return IN_PROGRESS;
+    return results_visible() ? LOST : IN_PROGRESS;
 }
 
 void Google::click(int x, int y) {
@@ -61,15 +77,25 @@ void Google::flag(int x, int y) {
     mouse_click(RIGHT_CLICK);
 }
 
+// Google reveals the neighbours of a satisfied number when the number itself is clicked
+void Google::chord(int x, int y) {
+    const Position pos = box_mouse_position(x, y);
+    move_mouse(pos);
+    mouse_click(LEFT_CLICK);
+}
+
 void Google::update() {
+    TRACE_SPAN("google.update");
     move_mouse({ 0, 0 }); // Move mouse out of the way of the game board
     screen.take_screenshot();
 
+    unknown_tiles = 0;
     std::vector<Tile> tiles = board->get_all_tiles();
     for (const Tile& tile : tiles) {
         if (tile.value < MINE) { // Don't update already detected values
         int value = tile_value(tile.x, tile.y);
         board->set_tile(tile.x, tile.y, value);
+        unknown_tiles += value == UNKNOWN;
         }
     }
 }
@@ -169,58 +195,25 @@ int Google::classify_pixel(const Pixel& pixel) {
 // Finding the game board
 
 static Dimension find_box_dimensions(Screen& screen, const Position& top_left) {
-    uint32_t width = 0;
-    uint32_t height = 0;
+    // The first dark tile along the top row and down the left column ends the first light tile
+    const PixelSpan row = screen.row(top_left.y, top_left.x);
+    const PixelSpan column = screen.column(top_left.x, top_left.y);
+    const uint32_t width = row.find(DARK_UND, 5);
+    const uint32_t height = column.find(DARK_UND, 5);
 
-    // Find width
-    
-    for (Screen::PixelIterator it = screen.iterate_from(top_left); it.position() <= it.end(); it.next()) {
-        Position pos = it.position();
-        if (color_in_range(it.pixel(), DARK_UND, 5)) {
-            width = pos.x - top_left.x;
-            break;
-        }
-    }
-
-    // Find y
-    for (Screen::PixelIterator it = screen.iterate_from(top_left); it.position() <= it.end(); it.next_row()) {
-        Position pos = it.position();
-        if (color_in_range(it.pixel(), DARK_UND, 5)) {
-            height = pos.y - top_left.y;
-            break;
-        }
-    }
-    
     // Return dimensions
-    return Dimension(width, height);
+    return Dimension(width < row.length ? width : 0, height < column.length ? height : 0);
 }
 
 static Dimension find_board_dimensions(Screen& screen, const Position& top_left) {
-    uint32_t width = 0;
-    uint32_t height = 0;
-
-    // Find width
-    for (Screen::PixelIterator it = screen.iterate_from(top_left); it.position() <= it.end(); it.next()) {
-        Position pos = it.position();
-        Pixel pixel = it.pixel();
-        if (!color_in_range(pixel, LIGHT_UND, 5) && !color_in_range(pixel, DARK_UND, 5)) {
-            width = pos.x - top_left.x;
-            break;
-        }
-    }
-
-    // Find y
-    for (Screen::PixelIterator it = screen.iterate_from(top_left); it.position() <= it.end(); it.next_row()) {
-        Position pos = it.position();
-        Pixel pixel = it.pixel();
-        if (!color_in_range(pixel, LIGHT_UND, 5) && !color_in_range(pixel, DARK_UND, 5)) {
-            height = pos.y - top_left.y;
-            break;
-        }
-    }
+    // The board ends at the first pixel that is neither undiscovered shade
+    const PixelSpan row = screen.row(top_left.y, top_left.x);
+    const PixelSpan column = screen.column(top_left.x, top_left.y);
+    const uint32_t width = row.find_unlike(LIGHT_UND, DARK_UND, 5);
+    const uint32_t height = column.find_unlike(LIGHT_UND, DARK_UND, 5);
 
     // Return dimensions
-    return Dimension(width, height);
+    return Dimension(width < row.length ? width : 0, height < column.length ? height : 0);
 }
 
 std::unique_ptr<Google> Google::find_game() {
@@ -229,9 +222,10 @@ std::unique_ptr<Google> Google::find_game() {
    
     while (true) {
         screen.take_screenshot();
-        for (Screen::PixelIterator it = screen.begin(); it.position() <= it.end(); it.next()) {
-            if (color_in_range(it.pixel(), LIGHT_UND)) {
-                Position position = it.position();
+        for (uint32_t y = 0; y < screen.get_dimension().height; y++) {
+            const PixelSpan row = screen.row(y);
+            for (uint32_t x = row.find(LIGHT_UND, 10); x < row.length; x = row.find(LIGHT_UND, 10, x + 1)) {
+                Position position(x, y);
                 Dimension box_dimensions = find_box_dimensions(screen, position);
                 Dimension board_dimensions = find_board_dimensions(screen, position);
 
@@ -12,6 +12,8 @@ public:
     void update() override;
     void click(int x, int y) override;
     void flag(int x, int y) override;
+    void chord(int x, int y) override;
+    bool supports_chord() const override { return true; }
 	int get_failed_cycle_threshold() override { return 4; }
 
 private:
@@ -23,6 +25,11 @@ private:
     // Screen object used
     Screen screen;
 
+    // Game over detection
+    std::vector<Position> results_samples; // Screen points inside the area the results overlay covers
+    int unknown_tiles = 0; // Tiles the last update could not recognise
+    bool results_visible() const;
+
     // Helper methods
     Position box_mouse_position(int x, int y) const;
     int tile_value(int x, int y) const;
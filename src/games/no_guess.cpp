@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdint>
+#include "no_guess.h"
+
+namespace {
+	enum CellState : uint8_t {
+		HIDDEN,
+		REVEALED,
+		FLAGGED
+	};
+
+	// Replays the solver's deductions on a candidate layout, repairing it in place when they stall
+	class NoGuessGenerator {
+	public:
+		NoGuessGenerator(const Board& b, std::mt19937& g) : board(b), generator(g), size(b.get_width() * b.get_height()),
+			mine(size), count(size), state(size) {}
+
+		bool run(int mine_count, int start_index, std::vector<bool>& mines, NoGuessStats& stats) {
+			// Tiles allowed to hold mines, everything outside the opening
+			std::vector<int> candidates;
+			const NeighbourList start_neighbours = board.neighbours(start_index);
+			for (int i = 0; i < size; i++) {
+				if (i != start_index && std::find(start_neighbours.begin(), start_neighbours.end(), i) == start_neighbours.end()) {
+					candidates.push_back(i);
+				}
+			}
+
+			bool solved = false;
+			for (int attempt = 0; attempt < NO_GUESS_MAX_RESTARTS && !solved; attempt++) {
+				stats.restarts += attempt > 0;
+				place_random(candidates, mine_count);
+				solved = solve(start_index, size - mine_count, stats);
+			}
+
+			mines.assign(size, false);
+			for (int i = 0; i < size; i++) {
+				mines[i] = mine[i] != 0;
+			}
+			return solved;
+		}
+
+	private:
+		const Board& board;
+		std::mt19937& generator;
+		const int size;
+		std::vector<uint8_t> mine;
+		std::vector<uint8_t> count; // Mines around each tile
+		std::vector<CellState> state;
+		std::vector<int> queue;     // Revealed tiles whose constraint may allow a deduction
+		std::vector<int> cascade;   // Tiles revealed by a click that still need their neighbours visited
+		int revealed = 0;
+
+		void place_random(const std::vector<int>& candidates, int mine_count) {
+			std::vector<int> chosen;
+			std::sample(candidates.begin(), candidates.end(), std::back_inserter(chosen), mine_count, generator);
+			std::fill(mine.begin(), mine.end(), 0);
+			std::fill(count.begin(), count.end(), 0);
+			for (int index : chosen) {
+				set_mine(index, true);
+			}
+		}
+
+		void set_mine(int index, bool value) {
+			mine[index] = value;
+			for (int n : board.neighbours(index)) {
+				count[n] += value ? 1 : -1;
+			}
+		}
+
+		// Matches Virtual::click, zeros open their neighbours
+		void reveal(int index) {
+			if (state[index] != HIDDEN) {
+				return;
+			}
+			state[index] = REVEALED;
+			revealed++;
+			cascade.push_back(index);
+			while (!cascade.empty()) {
+				const int current = cascade.back();
+				cascade.pop_back();
+				queue.push_back(current);
+				for (int n : board.neighbours(current)) {
+					if (count[current] == 0 && state[n] == HIDDEN) {
+						state[n] = REVEALED;
+						revealed++;
+						cascade.push_back(n);
+					}
+					else if (state[n] == REVEALED) {
+						queue.push_back(n);
+					}
+				}
+			}
+		}
+
+		void flag(int index) {
+			state[index] = FLAGGED;
+			for (int n : board.neighbours(index)) {
+				if (state[n] == REVEALED) {
+					queue.push_back(n);
+				}
+			}
+		}
+
+		// Same rule as analyze_component: a constraint either has all its mines flagged or all its hidden tiles are mines
+		void deduce() {
+			while (!queue.empty()) {
+				const int index = queue.back();
+				queue.pop_back();
+
+				int hidden = 0;
+				int flagged = 0;
+				const NeighbourList neighbours = board.neighbours(index);
+				for (int n : neighbours) {
+					hidden += state[n] == HIDDEN;
+					flagged += state[n] == FLAGGED;
+				}
+				const int remaining = count[index] - flagged;
+				if (hidden == 0 || (remaining != 0 && remaining != hidden)) {
+					continue;
+				}
+				for (int n : neighbours) {
+					if (state[n] == HIDDEN) {
+						remaining == 0 ? reveal(n) : flag(n);
+					}
+				}
+			}
+		}
+
+		bool solve(int start_index, int safe_tiles, NoGuessStats& stats) {
+			std::fill(state.begin(), state.end(), HIDDEN);
+			queue.clear();
+			revealed = 0;
+			reveal(start_index);
+
+			std::vector<int> frontier_mines;
+			std::vector<int> destinations;
+			while (true) {
+				deduce();
+				if (revealed == safe_tiles) {
+					return true;
+				}
+
+				// Stuck, find hidden mines next to the revealed area and hidden tiles away from it
+				frontier_mines.clear();
+				destinations.clear();
+				for (int i = 0; i < size; i++) {
+					if (state[i] != HIDDEN) {
+						continue;
+					}
+					bool touches_revealed = false;
+					for (int n : board.neighbours(i)) {
+						touches_revealed |= state[n] == REVEALED;
+					}
+					if (touches_revealed && mine[i]) {
+						frontier_mines.push_back(i);
+					}
+					else if (!touches_revealed && !mine[i]) {
+						destinations.push_back(i);
+					}
+				}
+				if (frontier_mines.empty() || destinations.empty()) {
+					return false;
+				}
+
+				// Moving the mine only changes numbers around the frontier, so revealed and flagged tiles stay correct
+				const int from = frontier_mines[std::uniform_int_distribution<size_t>(0, frontier_mines.size() - 1)(generator)];
+				const int to = destinations[std::uniform_int_distribution<size_t>(0, destinations.size() - 1)(generator)];
+				set_mine(from, false);
+				set_mine(to, true);
+				stats.repairs++;
+				for (int n : board.neighbours(from)) {
+					if (state[n] == REVEALED) {
+						queue.push_back(n);
+					}
+				}
+			}
+		}
+	};
+}
+
+bool generate_no_guess(const Board& board, int mine_count, int start_index, std::mt19937& generator,
+	std::vector<bool>& mines, NoGuessStats* stats) {
+	NoGuessStats local;
+	NoGuessGenerator no_guess = NoGuessGenerator(board, generator);
+	const bool solved = no_guess.run(mine_count, start_index, mines, stats ? *stats : local);
+	return solved;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <random>
+#include <vector>
+#include "core/board.h"
+
+// Counters of a single no-guess generation
+struct NoGuessStats {
+	int repairs = 0;  // Mines moved off a stuck frontier
+	int restarts = 0; // Fresh random layouts after running out of room for repairs
+};
+
+constexpr int NO_GUESS_MAX_RESTARTS = 20;
+
+// Places mine_count mines so the board can be solved from start_index with the solver's single-constraint
+// deductions alone, never touching the start tile or its neighbours. Deduction runs from a random layout and,
+// whenever it gets stuck, a frontier mine is moved to an unexplored tile so it can carry on from what it knew.
+// Returns false after NO_GUESS_MAX_RESTARTS failed layouts, leaving the last one in mines.
+bool generate_no_guess(const Board& board, int mine_count, int start_index, std::mt19937& generator,
+	std::vector<bool>& mines, NoGuessStats* stats = nullptr);
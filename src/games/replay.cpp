@@ -0,0 +1,96 @@
+#include <iomanip>
+#include <iostream>
+#include "replay.h"
+
+void Latency::add(std::chrono::nanoseconds time) {
+    calls++;
+    total += time;
+    max = std::max(max, time);
+}
+
+std::unique_ptr<Replay> Replay::open(const std::string& path, bool recorded_speed) {
+    auto player = std::make_unique<session::Player>(path, recorded_speed);
+    session::set_player(player.get());
+    try {
+        std::unique_ptr<Google> google = Google::find_game();
+        return std::make_unique<Replay>(std::move(player), std::move(google));
+    }
+    catch (...) {
+        session::set_player(nullptr);
+        throw;
+    }
+}
+
+// The move delay is already part of the recorded frame times, so the solver itself never waits
+Replay::Replay(std::unique_ptr<session::Player> p, std::unique_ptr<Google> g) :
+    Game("Replay", g->get_board()->get_width(), g->get_board()->get_height(), std::chrono::milliseconds(0)),
+    player(std::move(p)), google(std::move(g)) {
+    board = google->get_board();
+}
+
+Replay::~Replay() {
+    if (session::active_player() == player.get()) {
+        session::set_player(nullptr);
+    }
+}
+
+Status Replay::status() {
+    const auto start = std::chrono::steady_clock::now();
+    const Status result = google->status();
+    recognise.add(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+void Replay::update() {
+    const std::chrono::nanoseconds decoded_before = player->get_stats().decode_time;
+    const auto start = std::chrono::steady_clock::now();
+    google->update();
+    const std::chrono::nanoseconds decoding = player->get_stats().decode_time - decoded_before;
+    recognise.add(std::chrono::steady_clock::now() - start - decoding);
+}
+
+void Replay::click(int x, int y) {
+    const auto start = std::chrono::steady_clock::now();
+    google->click(x, y);
+    act.add(std::chrono::steady_clock::now() - start);
+}
+
+void Replay::flag(int x, int y) {
+    const auto start = std::chrono::steady_clock::now();
+    google->flag(x, y);
+    act.add(std::chrono::steady_clock::now() - start);
+}
+
+void Replay::chord(int x, int y) {
+    const auto start = std::chrono::steady_clock::now();
+    google->chord(x, y);
+    act.add(std::chrono::steady_clock::now() - start);
+}
+
+bool Replay::decisions_match() const {
+    const session::ReplayStats& stats = player->get_stats();
+    return stats.mismatched == 0 && stats.missing == 0 && stats.extra == 0;
+}
+
+void Replay::print_report(const SolverStats& stats) const {
+    auto print_latency = [](const std::string& name, int calls, std::chrono::nanoseconds total, std::chrono::nanoseconds max) {
+        std::cout << name << ": " << calls << " calls, " << std::fixed << std::setprecision(1)
+            << (calls > 0 ? std::chrono::duration<double, std::micro>(total).count() / calls : 0.0) << " us mean";
+        if (max.count() > 0) {
+            std::cout << ", " << std::chrono::duration<double, std::micro>(max).count() << " us max";
+        }
+        std::cout << std::endl;
+    };
+
+    const session::ReplayStats& replay = player->get_stats();
+    std::cout << "Frames: " << replay.frames << ", inputs matched: " << replay.matched << ", mismatched: " << replay.mismatched
+        << ", missing: " << replay.missing << ", extra: " << replay.extra << std::endl;
+    std::cout << (decisions_match() ? "Decisions match the recording" : "Decisions differ from the recording at " + replay.first_divergence)
+        << std::endl;
+    print_latency("Capture", replay.frames, replay.decode_time, std::chrono::nanoseconds(0));
+    print_latency("Recognise", recognise.calls, recognise.total, recognise.max);
+    for (const StageStats& stage : stats.stages) {
+        print_latency("Solve " + stage.name, static_cast<int>(stage.calls), stage.time, std::chrono::nanoseconds(0));
+    }
+    print_latency("Act", act.calls, act.total, act.max);
+}
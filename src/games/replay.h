@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include "core/game.h"
+#include "core/solver.h"
+#include "utils/session.h"
+#include "google.h"
+
+// Time spent in one part of the capture, recognise, solve and act loop
+struct Latency {
+    int calls = 0;
+    std::chrono::nanoseconds total{ 0 };
+    std::chrono::nanoseconds max{ 0 };
+    void add(std::chrono::nanoseconds time);
+};
+
+// A recorded Google session played again: screenshots come from the session file and go through Google's board
+// recognition, and the mouse inputs the solver sends are compared with the recorded ones instead of being sent
+class Replay final : public Game {
+public:
+    // Finds the board in the recorded frames like Google::find_game does on the screen.
+    // At recorded speed each frame waits for its recorded time, otherwise frames are served as fast as they decode
+    static std::unique_ptr<Replay> open(const std::string& path, bool recorded_speed);
+    Replay(std::unique_ptr<session::Player> p, std::unique_ptr<Google> g);
+    ~Replay();
+    Status status() override;
+    void update() override;
+    void click(int x, int y) override;
+    void flag(int x, int y) override;
+    void chord(int x, int y) override;
+    bool supports_chord() const override { return google->supports_chord(); }
+    int get_failed_cycle_threshold() override { return google->get_failed_cycle_threshold(); }
+
+    bool decisions_match() const;
+    void print_report(const SolverStats& stats) const;
+
+private:
+    std::unique_ptr<session::Player> player;
+    std::unique_ptr<Google> google;
+    Latency recognise; // Board updates and status checks, without frame decoding
+    Latency act;       // Inputs, which only go as far as the comparison with the recording
+};
@@ -1,26 +1,51 @@
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <algorithm>
 #include <cassert>
-#include "utils/util.h"
+#include "no_guess.h"
 #include "virtual.h"
 
-Virtual::Virtual(int w, int h, int m, std::chrono::milliseconds d) : Game("Virtual", w, h, d) {
+Virtual::Virtual(int w, int h, int m, std::chrono::milliseconds d, std::optional<unsigned int> s, bool specialise)
+    : Game("Virtual", w, h, d, specialise) {
     mines = m;
-    board = std::make_shared<Board>(w, h);
+    seed = s;
 }
 
 void Virtual::create_board(int start_x, int start_y) {
+    if (no_guess) {
+        // Same seed, same board, as long as the first click is the same
+        std::mt19937 generator(seed ? *seed : std::random_device{}());
+        std::vector<bool> layout;
+        // Each round already restarts NO_GUESS_MAX_RESTARTS times, the generator keeps advancing so retries see new layouts
+        constexpr int MAX_ROUNDS = 10;
+        int round = 0;
+        while (!generate_no_guess(*board, mines, board->to_index(start_x, start_y), generator, layout)) {
+            if (++round == MAX_ROUNDS) {
+                throw std::runtime_error("Could not generate a no-guess " + std::to_string(board->get_width()) + "x"
+                    + std::to_string(board->get_height()) + " board with " + std::to_string(mines) + " mines");
+            }
+        }
+        tiles = std::vector<VirtualTile>(layout.size());
+        for (size_t i = 0; i < layout.size(); i++) {
+            tiles[i].mine = layout[i];
+        }
+        return;
+    }
+
     // Ban the starting tile and its surrounding tiles from being mines
-    std::vector<std::pair<int, int>> illegal_tiles = get_surrounding_tiles(start_x, start_y);
-    illegal_tiles.push_back(std::pair<int, int>(start_x, start_y));
+    const int start_index = board->to_index(start_x, start_y);
+    const NeighbourList start_neighbours = board->neighbours(start_index);
+    std::vector<int> illegal_tiles(start_neighbours.begin(), start_neighbours.end());
+    illegal_tiles.push_back(start_index);
 
     // Determine possible mine coordinates
     std::vector<Tile> board_tiles = board->get_all_tiles();
     std::vector<std::pair<int, int>> possible_mine_coordinates;
     for (Tile tile : board_tiles) {
         bool illegal = false;
-        for (std::pair<int, int> illegal_tile : illegal_tiles) {
-            if (tile.x == illegal_tile.first && tile.y == illegal_tile.second) {
+        for (int illegal_tile : illegal_tiles) {
+            if (board->to_index(tile.x, tile.y) == illegal_tile) {
                 illegal = true;
                 break;
             }
@@ -31,35 +56,27 @@ void Virtual::create_board(int start_x, int start_y) {
     }
 
     // Get mine coordinates
-    std::random_device rd;
-    std::mt19937 generator(rd());
+    std::mt19937 generator(seed ? *seed : std::random_device{}());
     std::vector<std::pair<int, int>> mine_coordinates;
     std::sample(possible_mine_coordinates.begin(), possible_mine_coordinates.end(), 
         std::back_inserter(mine_coordinates), mines, generator);
 
     // Create the internal board
-    tiles = std::vector<std::vector<VirtualTile>>(board->get_height(), std::vector<VirtualTile>(board->get_width()));
+    tiles = std::vector<VirtualTile>(board->get_height() * board->get_width());
     for (std::pair<int, int> mine_coordinate : mine_coordinates) {
         assert(mine_coordinate.first != start_x || mine_coordinate.second != start_y);
-        tiles[mine_coordinate.second][mine_coordinate.first].mine = true;
+        tiles[board->to_index(mine_coordinate.first, mine_coordinate.second)].mine = true;
     }
 }
 
-std::vector<std::pair<int, int>> Virtual::get_surrounding_tiles(int x, int y) {
-    return surrounding_tiles<std::pair<int, int>>(x, y, width, height, [&](int xx, int yy) {
-        return std::pair<int, int>(xx, yy);
-        });
-}
-
-int Virtual::tile_value(int x, int y) {
-    if (tiles[y][x].mine) {
+int Virtual::tile_value(int index) {
+    if (tiles[index].mine) {
         return MINE;
     }
 
     int value = 0;
-    std::vector<std::pair<int, int>> surrounding_tiles = get_surrounding_tiles(x, y);
-    for (std::pair<int, int> surrounding_tile : surrounding_tiles) {
-        if (tiles[surrounding_tile.second][surrounding_tile.first].mine) {
+    for (int n : board->neighbours(index)) {
+        if (tiles[n].mine) {
             value++;
         }
     }
@@ -71,30 +88,61 @@ void Virtual::click(int x, int y) {
         create_board(x, y);
     }
     
-    if (tiles[y][x].clicked) {
+    const int index = board->to_index(x, y);
+    if (tiles[index].clicked) {
         return;
     }
-    VirtualTile* current_vtile = &tiles[y][x];
+    VirtualTile* current_vtile = &tiles[index];
     current_vtile->clicked = true;
 
-    int value = tile_value(x, y);
+    int value = tile_value(index);
     if (value == 0) {
-        std::vector<std::pair<int, int>> surrounding_tiles = get_surrounding_tiles(x, y);
-        for (std::pair<int, int> surrounding_tile : surrounding_tiles) {
-            click(surrounding_tile.first, surrounding_tile.second);
+        for (int n : board->neighbours(index)) {
+            click(n % width, n / width);
+        }
+    }
+}
+
+void Virtual::flag(int x, int y) {
+    if (!tiles.empty()) {
+        tiles[board->to_index(x, y)].flagged = true;
+    }
+}
+
+// Like the real game, a chord on a number without exactly that many flags around it does nothing
+void Virtual::chord(int x, int y) {
+    const int index = board->to_index(x, y);
+    if (tiles.empty() || !tiles[index].clicked) {
+        return;
+    }
+
+    const NeighbourList neighbours = board->neighbours(index);
+    int flags = 0;
+    for (int n : neighbours) {
+        flags += tiles[n].flagged;
+    }
+    if (flags != tile_value(index)) {
+        return;
+    }
+    for (int n : neighbours) {
+        if (!tiles[n].flagged) {
+            click(n % width, n / width);
         }
     }
 }
 
-void Virtual::flag(int x, int y) {}
+std::vector<bool> Virtual::get_mine_layout() const {
+    std::vector<bool> layout(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++) {
+        layout[i] = tiles[i].mine;
+    }
+    return layout;
+}
 
 void Virtual::update() {
-    for (int i = 0; i < board->get_height(); i++) {
-        for (int j = 0; j < board->get_width(); j++) {
-            VirtualTile* vtile = &tiles[i][j];
-            if (vtile->clicked) {
-                board->set_tile(j, i, tile_value(j, i));
-            }
+    for (int i = 0; i < static_cast<int>(tiles.size()); i++) {
+        if (tiles[i].clicked) {
+            board->set_tile(i % width, i / width, tile_value(i));
         }
     }
 }
@@ -104,17 +152,14 @@ Status Virtual::status() {
         return IN_PROGRESS;
     }
     bool unclicked_non_mine = false;
-    for (int i = 0; i < board->get_height(); i++) {
-        for (int j = 0; j < board->get_width(); j++) {
-            VirtualTile vtile = tiles[i][j];
-            if (vtile.clicked && vtile.mine) {
-                return LOST;
-            }
-            else if (!vtile.clicked && !vtile.mine) {
-                unclicked_non_mine = true;
-            }
+    for (const VirtualTile& vtile : tiles) {
+        if (vtile.clicked && vtile.mine) {
+            return LOST;
+        }
+        else if (!vtile.clicked && !vtile.mine) {
+            unclicked_non_mine = true;
         }
     }
     
     return unclicked_non_mine ? IN_PROGRESS : WON;
-}
\ No newline at end of file
+}
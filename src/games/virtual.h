@@ -1,28 +1,37 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include <optional>
 
 #include "core/game.h"
 
 struct VirtualTile {
 	bool mine;
 	bool clicked;
-	VirtualTile() : mine(false), clicked(false) {}
+	bool flagged;
+	VirtualTile() : mine(false), clicked(false), flagged(false) {}
 };
 
-class Virtual : public Game {
+class Virtual final : public Game {
 public:
-	Virtual(int w, int h, int m, std::chrono::milliseconds d = std::chrono::milliseconds(0));
+	Virtual(int w, int h, int m, std::chrono::milliseconds d = std::chrono::milliseconds(0), std::optional<unsigned int> s = std::nullopt,
+		bool specialise = true);
 	void click(int x, int y) override;
 	void flag(int x, int y) override;
+	void chord(int x, int y) override;
+	bool supports_chord() const override { return true; }
 	void update() override;
 	Status status() override;
 	int get_failed_cycle_threshold() override { return 0; }
+	int get_mine_count() const override { return mines; }
+	std::vector<bool> get_mine_layout() const; // Empty until the first click places the mines
+	void set_no_guess(bool n) { no_guess = n; } // Generate a layout solvable without guessing from the first click
 private:
 	int mines;
-	std::vector<std::vector<VirtualTile>> tiles;
-	std::vector<std::pair<int, int>> get_surrounding_tiles(int x, int y);
+	std::optional<unsigned int> seed; // Fixed mine layout seed, random when empty
+	bool no_guess = false;
+	std::vector<VirtualTile> tiles; // Row-major, indexed like the board
 	void create_board(int start_x, int start_y);
-	int tile_value(int x, int y);
+	int tile_value(int index);
 };
 
@@ -0,0 +1,500 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "core/analysis.h"
+
+#include "daemon.h"
+
+// Socket helpers
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+static const socket_t INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+static void close_socket(socket_t s) { closesocket(s); }
+static void shutdown_socket(socket_t s) { shutdown(s, SD_BOTH); }
+static void shutdown_send(socket_t s) { shutdown(s, SD_SEND); }
+static int poll_socket(socket_t s, int timeout_ms) {
+    WSAPOLLFD fd = { s, POLLIN, 0 };
+    return WSAPoll(&fd, 1, timeout_ms);
+}
+static void init_sockets() {
+    static bool initialised = false;
+    if (!initialised) {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+        initialised = true;
+    }
+}
+static const int SEND_FLAGS = 0;
+#else
+using socket_t = int;
+static const socket_t INVALID_SOCKET_HANDLE = -1;
+static void close_socket(socket_t s) { close(s); }
+static void shutdown_socket(socket_t s) { shutdown(s, SHUT_RDWR); }
+static void shutdown_send(socket_t s) { shutdown(s, SHUT_WR); }
+static int poll_socket(socket_t s, int timeout_ms) {
+    pollfd fd = { s, POLLIN, 0 };
+    return poll(&fd, 1, timeout_ms);
+}
+static void init_sockets() {}
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+#endif
+
+static sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+static void send_all(socket_t s, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = send(s, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (n <= 0) {
+            return; // Peer went away, nothing left to do
+        }
+        sent += n;
+    }
+}
+
+// Reads the next line from the socket into line, keeping leftover bytes in buffer. Lines longer than max_length
+// are dropped as they arrive, so the buffer never holds more than max_length plus one chunk
+static LineStatus read_line(socket_t s, std::string& buffer, std::string& line, size_t max_length = std::string::npos) {
+    char chunk[4096];
+    size_t end;
+    bool too_long = false;
+    while ((end = buffer.find('\n')) == std::string::npos) {
+        if (buffer.size() > max_length) {
+            buffer.clear();
+            too_long = true;
+        }
+        int n = recv(s, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return LINE_CLOSED;
+        }
+        buffer.append(chunk, n);
+    }
+    if (too_long || end > max_length) {
+        buffer.erase(0, end + 1);
+        return LINE_TOO_LONG;
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return LINE_READ;
+}
+
+// Same for stdin
+static LineStatus read_stdin_line(std::string& line, size_t max_length) {
+    std::streambuf* in = std::cin.rdbuf();
+    line.clear();
+    bool too_long = false;
+    for (int c = in->sbumpc(); c != '\n'; c = in->sbumpc()) {
+        if (c == std::char_traits<char>::eof()) {
+            return line.empty() && !too_long ? LINE_CLOSED : too_long ? LINE_TOO_LONG : LINE_READ;
+        }
+        if (line.size() == max_length) {
+            line.clear();
+            too_long = true;
+        }
+        if (!too_long) {
+            line += static_cast<char>(c);
+        }
+    }
+    return too_long ? LINE_TOO_LONG : LINE_READ;
+}
+
+// Request handling
+
+static int cell_value(char c) {
+    switch (c) {
+    case '-':
+        return UNDISCOVERED;
+    case 'F':
+        return MINE;
+    case '?':
+        return UNKNOWN;
+    default:
+        if (c >= '0' && c <= '8') {
+            return c - '0';
+        }
+        throw std::runtime_error(std::string("invalid cell '") + c + "'");
+    }
+}
+
+std::string AnalysisServer::handle(const std::string& request) {
+    // Each worker thread keeps its own scratch, nothing is shared between requests
+    thread_local AnalysisScratch scratch;
+    thread_local AnalysisResult result;
+
+    std::istringstream in(request);
+    std::string id;
+    int width = 0;
+    int height = 0;
+    int mines = -1;
+    std::string cells;
+    in >> id;
+    try {
+        if (!(in >> width >> height >> mines >> cells)) {
+            throw std::runtime_error("expected ID WIDTH HEIGHT MINES CELLS");
+        }
+        if (width <= 0 || height <= 0 || width > MAX_BOARD_SIDE || height > MAX_BOARD_SIDE || cells.size() != static_cast<size_t>(width) * height) {
+            throw std::runtime_error("cells do not match a " + std::to_string(width) + "x" + std::to_string(height) + " board");
+        }
+
+        std::shared_ptr<Board> board = make_board(width, height);
+        for (int i = 0; i < width * height; i++) {
+            board->set_tile(i % width, i / width, cell_value(cells[i]));
+        }
+        analyze_board(*board, scratch, result, { true, mines });
+    }
+    catch (const std::exception& e) {
+        return (id.empty() ? "-" : id) + " error " + e.what();
+    }
+
+    std::string response = id + (result.guessed ? " 1 " : " 0 ");
+    if (result.moves.empty()) {
+        response += "-";
+    }
+    for (size_t i = 0; i < result.moves.size(); i++) {
+        const Move& move = result.moves[i];
+        response += (i > 0 ? ",": "") + std::string(move.action == FLAG_ACTION ? "f:" : "c:")
+            + std::to_string(move.x) + ":" + std::to_string(move.y);
+    }
+    response += ' ';
+
+    static const char HEX[] = "0123456789abcdef";
+    for (double p : result.probabilities) {
+        if (p == NO_INFORMATION) {
+            response += "..";
+        }
+        else {
+            const int scaled = static_cast<int>(p * 255.0 + 0.5);
+            response += HEX[scaled >> 4];
+            response += HEX[scaled & 0x0F];
+        }
+    }
+    return response;
+}
+
+// Server
+
+AnalysisServer::AnalysisServer(const ServerOptions& o) : options(o), start_time(std::chrono::steady_clock::now()) {
+    if (options.socket_path.empty()) {
+        throw std::runtime_error("Server needs a socket path, or - for stdin/stdout");
+    }
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options.max_batch = std::max<size_t>(options.max_batch, 1);
+    options.max_queue = std::max<size_t>(options.max_queue, 1);
+}
+
+AnalysisServer::~AnalysisServer() {
+    stop();
+    for (std::thread& t : workers) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+void AnalysisServer::submit(const std::shared_ptr<Connection>& connection, std::string line) {
+    {
+        // Blocking here stops this client's reader, so the socket or pipe pushes back on the sender
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_space.wait(lock, [&]() { return stopping || queue.size() < options.max_queue; });
+        if (stopping) {
+            return;
+        }
+        queue.push_back({ connection, std::move(line), std::chrono::steady_clock::now() });
+    }
+    queue_ready.notify_one();
+}
+
+void AnalysisServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_ready.notify_all();
+    queue_space.notify_all();
+}
+
+void AnalysisServer::worker() {
+    std::vector<Request> batch;
+    std::vector<std::pair<Connection*, std::string>> outputs;
+    while (true) {
+        batch.clear();
+        {
+            // Take everything that is waiting, up to the batch size, in one go
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_ready.wait(lock, [&]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return; // Stopping and drained
+            }
+            const size_t count = std::min(options.max_batch, queue.size());
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        queue_space.notify_all();
+        batches++;
+
+        // Answer the batch, joining the responses per connection so each gets a single write
+        outputs.clear();
+        for (const Request& request : batch) {
+            auto output = std::find_if(outputs.begin(), outputs.end(), [&](const auto& o) { return o.first == request.connection.get(); });
+            if (output == outputs.end()) {
+                outputs.emplace_back(request.connection.get(), std::string());
+                output = outputs.end() - 1;
+            }
+            output->second += handle(request.line);
+            output->second += '\n';
+        }
+        for (auto& [connection, data] : outputs) {
+            std::lock_guard<std::mutex> lock(connection->write_mutex);
+            connection->write(data);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (const Request& request : batch) {
+            const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - request.arrival).count();
+            size_t bucket = 0;
+            while (bucket + 1 < std::size(latency_buckets) && (1LL << (bucket + 1)) <= latency) {
+                bucket++;
+            }
+            latency_buckets[bucket]++;
+        }
+        requests += batch.size();
+    }
+}
+
+void AnalysisServer::read_lines(const std::shared_ptr<Connection>& connection, const std::function<LineStatus(std::string&)>& next_line) {
+    std::string line;
+    LineStatus status;
+    while (!stopping && (status = next_line(line)) != LINE_CLOSED) {
+        if (status == LINE_TOO_LONG) {
+            std::lock_guard<std::mutex> lock(connection->write_mutex);
+            connection->write("- error request is longer than " + std::to_string(MAX_REQUEST_LINE) + " bytes\n");
+            continue;
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line == "quit") {
+            stop();
+            return;
+        }
+        if (line == "stats") {
+            std::lock_guard<std::mutex> lock(connection->write_mutex);
+            connection->write(stats() + "\n");
+            continue;
+        }
+        submit(connection, std::move(line));
+    }
+}
+
+void AnalysisServer::run() {
+    for (unsigned int i = 0; i < options.threads; i++) {
+        workers.emplace_back(&AnalysisServer::worker, this);
+    }
+
+    if (options.socket_path == "-") {
+        serve_stdio();
+    }
+    else {
+        serve_socket();
+    }
+
+    stop();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    workers.clear();
+    std::cerr << stats() << std::endl;
+}
+
+void AnalysisServer::serve_stdio() {
+    auto connection = std::make_shared<Connection>();
+    connection->write = [](const std::string& data) { std::cout << data << std::flush; };
+    read_lines(connection, [](std::string& line) { return read_stdin_line(line, MAX_REQUEST_LINE); });
+}
+
+void AnalysisServer::serve_socket() {
+    init_sockets();
+    const sockaddr_un address = socket_address(options.socket_path);
+    socket_t listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET_HANDLE) {
+        throw std::runtime_error("Could not create socket");
+    }
+#ifndef _WIN32
+    unlink(options.socket_path.c_str());
+#endif
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        close_socket(listener);
+        throw std::runtime_error("Could not listen on " + options.socket_path);
+    }
+    std::cerr << "Listening on " << options.socket_path << " with " << options.threads << " workers" << std::endl;
+
+    // One reader thread per client, finished readers are joined as new clients arrive
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::mutex clients_mutex;
+    std::vector<socket_t> clients;
+    std::vector<Reader> readers;
+    while (!stopping) {
+        if (poll_socket(listener, 200) <= 0) {
+            continue; // Wake up regularly to notice quit
+        }
+        socket_t client = accept(listener, nullptr, nullptr);
+        if (client == INVALID_SOCKET_HANDLE) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.push_back(client);
+        }
+        for (auto it = readers.begin(); it != readers.end();) {
+            if (*it->done) {
+                it->thread.join();
+                it = readers.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        // The socket stays open until the last pending response for it has been written
+        std::shared_ptr<Connection> connection(new Connection(), [client](Connection* c) {
+            close_socket(client);
+            delete c;
+            });
+        connection->write = [client](const std::string& data) { send_all(client, data); };
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        readers.push_back({ std::thread([this, connection, client, done, &clients_mutex, &clients]() {
+            std::string buffer;
+            read_lines(connection, [&](std::string& line) { return read_line(client, buffer, line, MAX_REQUEST_LINE); });
+            {
+                std::lock_guard<std::mutex> lock(clients_mutex);
+                clients.erase(std::find(clients.begin(), clients.end(), client));
+            }
+            *done = true;
+            }), done });
+    }
+
+    // Unblock readers still waiting on their clients
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        for (socket_t client : clients) {
+            shutdown_socket(client);
+        }
+    }
+    for (Reader& reader : readers) {
+        reader.thread.join();
+    }
+    close_socket(listener);
+#ifndef _WIN32
+    unlink(options.socket_path.c_str());
+#endif
+}
+
+double AnalysisServer::latency_percentile(double p) const {
+    uint64_t total = 0;
+    for (const auto& bucket : latency_buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < std::size(latency_buckets); i++) {
+        seen += latency_buckets[i];
+        if (seen >= p * total) {
+            return static_cast<double>(1ULL << (i + 1)); // Upper edge of the bucket
+        }
+    }
+    return static_cast<double>(1ULL << std::size(latency_buckets));
+}
+
+std::string AnalysisServer::stats() const {
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    const uint64_t handled = requests;
+    const uint64_t batch_count = batches;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << "stats requests=" << handled
+        << " batches=" << batch_count
+        << " avg_batch=" << (batch_count > 0 ? static_cast<double>(handled) / batch_count : 0.0)
+        << " throughput=" << (elapsed > 0 ? handled / elapsed : 0.0) << "/s"
+        << std::setprecision(0)
+        << " p50_us<=" << latency_percentile(0.5)
+        << " p90_us<=" << latency_percentile(0.9)
+        << " p99_us<=" << latency_percentile(0.99);
+    return out.str();
+}
+
+// Client
+
+void run_client(const std::string& socket_path) {
+    init_sockets();
+    const sockaddr_un address = socket_address(socket_path);
+    socket_t s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == INVALID_SOCKET_HANDLE || connect(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        if (s != INVALID_SOCKET_HANDLE) {
+            close_socket(s);
+        }
+        throw std::runtime_error("Could not connect to " + socket_path);
+    }
+
+    std::thread printer([s]() {
+        std::string buffer;
+        std::string response;
+        while (read_line(s, buffer, response) != LINE_CLOSED) {
+            std::cout << response << '\n';
+        }
+        std::cout << std::flush;
+        });
+
+    std::string line;
+    std::string pending;
+    while (std::getline(std::cin, line)) {
+        pending += line;
+        pending += '\n';
+        if (pending.size() >= 64 * 1024) {
+            send_all(s, pending);
+            pending.clear();
+        }
+    }
+    send_all(s, pending);
+    shutdown_send(s);
+    printer.join();
+    close_socket(s);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long-running analysis server. Positions arrive one per line and are answered with
+// the certain moves (or a guess) and the mine probability of every tile.
+//
+// Request:  ID WIDTH HEIGHT MINES CELLS
+//   CELLS is one character per tile in board order: '-' undiscovered, 'F' flagged mine,
+//   '?' unknown and '0'-'8' for revealed numbers. MINES is -1 when the total is not known.
+// Response: ID GUESSED MOVES PROBABILITIES
+//   GUESSED is 1 when MOVES holds a guess. MOVES is '-' or a comma separated list of
+//   c:X:Y (click) and f:X:Y (flag). PROBABILITIES has two hex digits per tile (00 safe to
+//   ff mine), or '..' where nothing is known.
+// Errors are answered with: ID error MESSAGE
+// Boards are at most MAX_BOARD_SIDE tiles a side, and a line longer than a request for the largest board is
+// answered with "- error" and skipped without being buffered. A full request queue stops the server reading, so
+// a client sending many requests has to read responses as it goes, like --client does.
+// The control lines "stats" and "quit" report statistics and stop the server.
+
+constexpr int MAX_BOARD_SIDE = 10000;
+constexpr size_t MAX_REQUEST_LINE = static_cast<size_t>(MAX_BOARD_SIDE) * MAX_BOARD_SIDE + 256; // Cells plus the other fields
+
+enum LineStatus {
+    LINE_CLOSED,
+    LINE_READ,
+    LINE_TOO_LONG // The line was skipped up to and including its newline
+};
+
+struct ServerOptions {
+    std::string socket_path;  // "-" serves stdin/stdout
+    unsigned int threads = 0; // 0 uses every hardware thread
+    size_t max_batch = 64;    // Most requests a worker takes at once
+    size_t max_queue = 4096;  // Most requests waiting, readers stop reading until the workers catch up
+};
+
+class AnalysisServer {
+public:
+    explicit AnalysisServer(const ServerOptions& o);
+    ~AnalysisServer();
+    void run(); // Blocks until quit is received (or stdin closes)
+    std::string stats() const;
+
+    // Answers a single request line, exposed for clients that embed the server
+    static std::string handle(const std::string& request);
+
+private:
+    // Where responses for a request go
+    struct Connection {
+        std::function<void(const std::string&)> write;
+        std::mutex write_mutex;
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        std::string line;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    ServerOptions options;
+    std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::condition_variable queue_space;
+    std::deque<Request> queue;
+    std::atomic<bool> stopping{ false };
+    std::vector<std::thread> workers;
+
+    // Statistics
+    std::chrono::steady_clock::time_point start_time;
+    std::atomic<uint64_t> requests{ 0 };
+    std::atomic<uint64_t> batches{ 0 };
+    std::atomic<uint64_t> latency_buckets[32] = {}; // Power of two microsecond buckets
+
+    void submit(const std::shared_ptr<Connection>& connection, std::string line);
+    void worker();
+    void stop();
+    void read_lines(const std::shared_ptr<Connection>& connection, const std::function<LineStatus(std::string&)>& next_line);
+    void serve_stdio();
+    void serve_socket();
+    double latency_percentile(double p) const;
+};
+
+// Sends stdin lines to a running server and prints the responses
+void run_client(const std::string& socket_path);
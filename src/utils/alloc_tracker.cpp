@@ -0,0 +1,255 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "alloc_tracker.h"
+
+namespace {
+    // Constant initialised, with no dynamic initialiser or destructor, so operator new can touch it at any point of
+    // a thread's life
+    struct ThreadCounters {
+        alloc_tracker::Stats stats;
+        int64_t live = 0;                           // Bytes allocated minus bytes freed by this thread
+        int64_t base = 0;                           // live when the current phase was entered
+        alloc_tracker::Phase phase = alloc_tracker::OTHER_PHASE;
+    };
+    constinit thread_local ThreadCounters counters;
+
+#ifdef MSX_ALLOC_TRACKING
+    // Every block carries its size just before the pointer handed out, in a header as large as the block's alignment
+    constexpr size_t HEADER = alignof(std::max_align_t);
+
+    size_t header_size(size_t alignment) {
+        return std::max(alignment, HEADER);
+    }
+
+    void* count_allocation(void* block, size_t size, size_t header) {
+        char* p = static_cast<char*>(block) + header;
+        reinterpret_cast<size_t*>(p)[-1] = size;
+        counters.live += static_cast<int64_t>(size);
+        alloc_tracker::PhaseStats& stats = counters.stats[counters.phase];
+        stats.allocations++;
+        stats.bytes += size;
+        if (counters.live > counters.base) {
+            stats.peak_live = std::max(stats.peak_live, static_cast<uint64_t>(counters.live - counters.base));
+        }
+        return p;
+    }
+
+    void* count_free(void* p, size_t header) {
+        counters.live -= static_cast<int64_t>(static_cast<size_t*>(p)[-1]); // Goes negative for blocks from other threads
+        return static_cast<char*>(p) - header;
+    }
+
+    void* tracked_allocate(size_t size, std::align_val_t alignment = std::align_val_t(HEADER)) {
+        const size_t align = static_cast<size_t>(alignment);
+        const size_t header = header_size(align);
+        void* block;
+        if (align <= HEADER) {
+            block = std::malloc(size + header);
+        }
+        else {
+#ifdef _WIN32
+            block = _aligned_malloc(size + header, align);
+#else
+            block = std::aligned_alloc(align, (size + header + align - 1) / align * align);
+#endif
+        }
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        return count_allocation(block, size, header);
+    }
+
+    void tracked_free(void* p, std::align_val_t alignment = std::align_val_t(HEADER)) noexcept {
+        if (p == nullptr) {
+            return;
+        }
+        const size_t align = static_cast<size_t>(alignment);
+        void* block = count_free(p, header_size(align));
+        if (align <= HEADER) {
+            std::free(block);
+        }
+        else {
+#ifdef _WIN32
+            _aligned_free(block);
+#else
+            std::free(block);
+#endif
+        }
+    }
+
+    void* tracked_allocate_nothrow(size_t size, std::align_val_t alignment = std::align_val_t(HEADER)) noexcept {
+        try {
+            return tracked_allocate(size, alignment);
+        }
+        catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+#endif
+}
+
+#ifdef MSX_ALLOC_TRACKING
+void* operator new(std::size_t size) {
+    return tracked_allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return tracked_allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return tracked_allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return tracked_allocate(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate_nothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate_nothrow(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_allocate_nothrow(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_allocate_nothrow(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    tracked_free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    tracked_free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    tracked_free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    tracked_free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    tracked_free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    tracked_free(p);
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    tracked_free(p, alignment);
+}
+
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    tracked_free(p, alignment);
+}
+
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    tracked_free(p, alignment);
+}
+#endif
+
+const char* alloc_tracker::phase_name(Phase phase) {
+    switch (phase) {
+    case GET_MOVES_PHASE:
+        return "solver.get_moves";
+    case EXECUTE_MOVES_PHASE:
+        return "solver.execute_moves";
+    case DISPLAY_PHASE:
+        return "solver.display";
+    case GAME_CLICK_PHASE:
+        return "game.click";
+    case GAME_FLAG_PHASE:
+        return "game.flag";
+    case GAME_UPDATE_PHASE:
+        return "game.update";
+    default:
+        return "other";
+    }
+}
+
+alloc_tracker::Stats alloc_tracker::thread_stats() {
+    return counters.stats;
+}
+
+void alloc_tracker::reset_thread_stats() {
+    counters.stats = {};
+    counters.base = counters.live;
+}
+
+void alloc_tracker::merge(Stats& into, const Stats& from) {
+    for (size_t p = 0; p < into.size(); p++) {
+        into[p].allocations += from[p].allocations;
+        into[p].bytes += from[p].bytes;
+        into[p].peak_live = std::max(into[p].peak_live, from[p].peak_live);
+    }
+}
+
+alloc_tracker::Phase alloc_tracker::current_phase() {
+    return counters.phase;
+}
+
+void alloc_tracker::add_thread_stats(const Stats& stats) {
+    merge(counters.stats, stats);
+}
+
+size_t alloc_tracker::peak_rss_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) {
+        return info.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss); // Bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+alloc_tracker::PhaseScope::PhaseScope(Phase phase) : previous(counters.phase), previous_base(counters.base) {
+    counters.phase = phase;
+    counters.base = counters.live;
+}
+
+alloc_tracker::PhaseScope::~PhaseScope() {
+    counters.phase = previous;
+    counters.base = previous_base;
+}
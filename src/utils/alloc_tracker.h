@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocation counters per solver phase and game call, kept per thread by replacement global operator new and
+// delete, aligned and nothrow forms included. Loops on the work-stealing pool count their workers' allocations in the
+// caller's phase and add them to the caller's counters once the loop ends.
+// The hooks are only compiled in with -DMSX_ALLOC_TRACKING=ON; otherwise ALLOC_PHASE expands to nothing and every
+// counter reads zero.
+namespace alloc_tracker {
+    enum Phase {
+        OTHER_PHASE,         // Anything outside a scope, such as creating games and solvers
+        GET_MOVES_PHASE,     // Solver move generation
+        EXECUTE_MOVES_PHASE, // Solver bookkeeping around the game's click and flag
+        DISPLAY_PHASE,       // Verbose board display
+        GAME_CLICK_PHASE,
+        GAME_FLAG_PHASE,
+        GAME_UPDATE_PHASE,
+        PHASE_COUNT
+    };
+
+    struct PhaseStats {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t peak_live = 0; // Most bytes live at once above the level the phase was entered at
+    };
+
+    using Stats = std::array<PhaseStats, PHASE_COUNT>;
+
+#ifdef MSX_ALLOC_TRACKING
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    const char* phase_name(Phase phase);
+
+    // Counters of the calling thread since its last reset
+    Stats thread_stats();
+    void reset_thread_stats();
+
+    // Sums the counts of from into into, peaks combine as the larger of the two
+    void merge(Stats& into, const Stats& from);
+
+    // Phase the calling thread is in, and counts from other threads working on its behalf
+    Phase current_phase();
+    void add_thread_stats(const Stats& stats);
+
+    // Largest resident set of the process so far, 0 where unsupported
+    size_t peak_rss_bytes();
+
+    // Attributes the calling thread's allocations to a phase until destroyed, restoring the enclosing phase
+    class PhaseScope {
+    public:
+        explicit PhaseScope(Phase phase);
+        ~PhaseScope();
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+    private:
+        Phase previous;
+        int64_t previous_base;
+    };
+}
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+#ifdef MSX_ALLOC_TRACKING
+#define ALLOC_PHASE(phase) alloc_tracker::PhaseScope ALLOC_CONCAT(alloc_phase_, __LINE__)(alloc_tracker::phase)
+#else
+#define ALLOC_PHASE(phase) ((void)0)
+#endif
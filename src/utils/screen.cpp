@@ -1,4 +1,14 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include "screen.h"
+#include "session.h"
+#include "trace.h"
+
+#ifdef _WIN32
+Dimension virtual_screen_size() {
+    return { static_cast<uint32_t>(GetSystemMetrics(SM_CXVIRTUALSCREEN)), static_cast<uint32_t>(GetSystemMetrics(SM_CYVIRTUALSCREEN)) };
+}
 
 // Resource caching
 
@@ -20,6 +30,7 @@ bool Screen::init_resources() {
         bitmap = CreateCompatibleBitmap(screen_dc, dim.width, dim.height);
 
         bitmap_data = std::make_unique<uint8_t[]>(stride * dim.height);
+        pixels = bitmap_data.get();
     }
 
     return true;
@@ -40,7 +51,7 @@ void Screen::clean_resources() {
     }
 }
 
-Screen::Screen(Position p, Dimension d) : pos(p), dim(d), stride(0),
+Screen::Screen(Position p, Dimension d, CaptureMode m) : pos(p), dim(d), mode(m), stride(0),
     screen_dc(nullptr), memory_dc(nullptr), bitmap(nullptr) {
 	init_resources();
 }
@@ -50,6 +61,10 @@ Screen::~Screen() {
 }
 
 void Screen::take_screenshot() {
+    TRACE_SPAN("screen.take_screenshot");
+    if (replay_screenshot()) {
+        return;
+    }
     if (dim.width == 0 || dim.height == 0) {
         throw ScreenshotException("Invalid dimensions: width and height must be greater than 0");
     }
@@ -81,68 +96,200 @@ void Screen::take_screenshot() {
         SelectObject(memory_dc, oldBitmap);
         throw ScreenshotException("Failed to get bitmap data");
     }
+    record_screenshot();
+}
+#endif
+
+// A replayed frame replaces the capture and brings its own rectangle, so a replay needs no display at all
+bool Screen::replay_screenshot() {
+    session::Player* player = session::active_player();
+    if (player == nullptr) {
+        return false;
+    }
+    const session::Frame& frame = player->next_frame();
+    pos = frame.pos;
+    dim = frame.dim;
+    stride = dim.width * 3;
+    pixel_size = 3;
+    pixels = frame.pixels.data();
+    return true;
+}
+
+void Screen::record_screenshot() const {
+    if (session::Recorder* recorder = session::active_recorder()) {
+        recorder->frame(pos, dim, pixels, stride, pixel_size);
+    }
 }
 
 Pixel Screen::get_pixel(uint32_t x, uint32_t y) const noexcept {
-    size_t offset = y * stride + x * 3;
+    size_t offset = static_cast<size_t>(y) * stride + x * pixel_size;
     return Pixel(
-        bitmap_data[offset + 2],  // R
-        bitmap_data[offset + 1],  // G
-        bitmap_data[offset]       // B
+        pixels[offset + 2],  // R
+        pixels[offset + 1],  // G
+        pixels[offset]       // B
     );
 }
 
-// Screen pixel iterator
-Screen::PixelIterator::PixelIterator(const Screen* s, Position sp, Position ep) : screen(s), curr_pos(sp), end_pos(ep) {}
+// Whether any pixel in the region is within range of color, a zero size scans to the edge of the screenshot
+bool Screen::contains_color(const Pixel& color, int range, Position start, Dimension size) const noexcept {
+    return rect(start, size).contains(color, range);
+}
+
+PixelSpan Screen::row(uint32_t y, uint32_t x, uint32_t length) const noexcept {
+    const uint32_t available = x < dim.width ? dim.width - x : 0;
+    length = length ? std::min(length, available) : available;
+    return { length ? pixels + static_cast<size_t>(y) * stride + static_cast<size_t>(x) * pixel_size : pixels, length, pixel_size };
+}
+
+PixelSpan Screen::column(uint32_t x, uint32_t y, uint32_t length) const noexcept {
+    const uint32_t available = y < dim.height ? dim.height - y : 0;
+    length = length ? std::min(length, available) : available;
+    return { length ? pixels + static_cast<size_t>(y) * stride + static_cast<size_t>(x) * pixel_size : pixels, length, stride };
+}
+
+PixelRect Screen::rect(Position start, Dimension size) const noexcept {
+    const uint32_t width = start.x < dim.width ? dim.width - start.x : 0;
+    const uint32_t height = start.y < dim.height ? dim.height - start.y : 0;
+    const Dimension clamped(size.width ? std::min(size.width, width) : width, size.height ? std::min(size.height, height) : height);
+    if (clamped.width == 0 || clamped.height == 0) {
+        return { pixels, Dimension{}, stride, pixel_size };
+    }
+    return { pixels + static_cast<size_t>(start.y) * stride + static_cast<size_t>(start.x) * pixel_size, clamped, stride, pixel_size };
+}
+
+// Pixel spans
+
+namespace {
+    constexpr uint32_t SCAN_BLOCK = 64; // Pixels tested before looking for the first hit
+
+    // Per channel byte bounds, the same test as color_in_range without the subtractions
+    struct ColorRange {
+        uint8_t low[3];
+        uint8_t high[3];
+
+        ColorRange(const Pixel& color, int range) {
+            const int channels[3] = { color.blue, color.green, color.red };
+            for (int c = 0; c < 3; c++) {
+                low[c] = static_cast<uint8_t>(std::clamp(channels[c] - range, 0, 255));
+                high[c] = static_cast<uint8_t>(std::clamp(channels[c] + range, 0, 255));
+            }
+        }
+
+        bool operator()(const uint8_t* pixel) const noexcept {
+            return (pixel[0] >= low[0]) & (pixel[0] <= high[0])
+                & (pixel[1] >= low[1]) & (pixel[1] <= high[1])
+                & (pixel[2] >= low[2]) & (pixel[2] <= high[2]);
+        }
+    };
 
-Pixel Screen::PixelIterator::pixel() const noexcept { 
-    return screen->get_pixel(curr_pos.x, curr_pos.y);
+    struct UnlikeBoth {
+        ColorRange a;
+        ColorRange b;
+
+        bool operator()(const uint8_t* pixel) const noexcept {
+            return !a(pixel) & !b(pixel);
+        }
+    };
+
+    // STEP is the compile time pixel step for packed rows, 0 reads it from the span
+    template <uint32_t STEP, typename Match>
+    uint32_t find_block(const PixelSpan& span, uint32_t from, Match match) noexcept {
+        const size_t step = STEP ? STEP : span.step;
+        uint8_t hits[SCAN_BLOCK];
+        for (uint32_t start = from; start < span.length; start += SCAN_BLOCK) {
+            const uint32_t count = std::min(SCAN_BLOCK, span.length - start);
+            const uint8_t* block = span.data + start * step;
+            for (uint32_t i = 0; i < count; i++) {
+                hits[i] = match(block + i * step);
+            }
+            if (const void* hit = std::memchr(hits, 1, count)) {
+                return start + static_cast<uint32_t>(static_cast<const uint8_t*>(hit) - hits);
+            }
+        }
+        return span.length;
+    }
+
+    template <uint32_t STEP, typename Match>
+    uint32_t count_matches(const PixelSpan& span, Match match) noexcept {
+        const size_t step = STEP ? STEP : span.step;
+        uint32_t matches = 0;
+        for (uint32_t i = 0; i < span.length; i++) {
+            matches += match(span.data + i * step);
+        }
+        return matches;
+    }
+
+    template <typename Match>
+    uint32_t find_first(const PixelSpan& span, uint32_t from, Match match) noexcept {
+        switch (span.step) {
+        case 3: return find_block<3>(span, from, match);
+        case 4: return find_block<4>(span, from, match);
+        default: return find_block<0>(span, from, match);
+        }
+    }
 }
 
-Position Screen::PixelIterator::position() const noexcept { 
-    return curr_pos;
+Pixel PixelSpan::operator[](uint32_t i) const noexcept {
+    const uint8_t* pixel = data + static_cast<size_t>(i) * step;
+    return Pixel(pixel[2], pixel[1], pixel[0]);
 }
 
-Position Screen::PixelIterator::end() const noexcept {
-    return end_pos;
+uint32_t PixelSpan::find(const Pixel& color, int range, uint32_t from) const noexcept {
+    return find_first(*this, from, ColorRange(color, range));
 }
 
-Screen::PixelIterator& Screen::PixelIterator::next() noexcept {
-    if (++curr_pos.x >= screen->get_dimension().width) {
-        curr_pos.x = 0;
-        ++curr_pos.y;
+uint32_t PixelSpan::find_unlike(const Pixel& a, const Pixel& b, int range, uint32_t from) const noexcept {
+    return find_first(*this, from, UnlikeBoth{ ColorRange(a, range), ColorRange(b, range) });
+}
+
+uint32_t PixelSpan::count(const Pixel& color, int range) const noexcept {
+    const ColorRange match(color, range);
+    switch (step) {
+    case 3: return count_matches<3>(*this, match);
+    case 4: return count_matches<4>(*this, match);
+    default: return count_matches<0>(*this, match);
     }
-    return *this;
 }
 
-// Skip to specific position
-Screen::PixelIterator& Screen::PixelIterator::jump_to(Position new_pos) noexcept {
-    curr_pos = new_pos;
-    return *this;
+PixelSpan PixelRect::row(uint32_t y) const noexcept {
+    return { data + static_cast<size_t>(y) * stride, dim.width, pixel_size };
 }
 
-// Shift over 1 row
-Screen::PixelIterator& Screen::PixelIterator::next_row() noexcept {
-    ++curr_pos.y;
-    return *this;
+PixelSpan PixelRect::column(uint32_t x) const noexcept {
+    return { data + static_cast<size_t>(x) * pixel_size, dim.height, stride };
 }
 
-Screen::PixelIterator Screen::begin() const noexcept { 
-    return PixelIterator(this, Position(0, 0), Position(dim.width - 1, dim.height - 1));
+uint64_t PixelRect::count(const Pixel& color, int range) const noexcept {
+    uint64_t matches = 0;
+    for (uint32_t y = 0; y < dim.height; y++) {
+        matches += row(y).count(color, range);
+    }
+    return matches;
 }
 
-Screen::PixelIterator Screen::iterate_from(Position start_pos, Position end_pos) const noexcept {
-    if (end_pos == Position{}) {
-        end_pos = Position(dim.width - 1, dim.height - 1);
+// Rows are counted whole rather than searched, a hit is only checked for between rows
+bool PixelRect::contains(const Pixel& color, int range) const noexcept {
+    for (uint32_t y = 0; y < dim.height; y++) {
+        if (row(y).count(color, range) > 0) {
+            return true;
+        }
     }
-    return PixelIterator(this, start_pos, end_pos);
+    return false;
 }
 
+#ifdef _WIN32
 void move_mouse(Position pos) {
+    if (session::intercept({ session::MOVE_RECORD, pos, LEFT_CLICK })) {
+        return;
+    }
     SetCursorPos(pos.x, pos.y);
 }
 
 void mouse_click(MouseAction action) {
+    if (session::intercept({ session::CLICK_RECORD, {}, action })) {
+        return;
+    }
+
     // Press the left mouse button
     INPUT inputDown = {};
     inputDown.type = INPUT_MOUSE;
@@ -156,4 +303,5 @@ void mouse_click(MouseAction action) {
     // Send both events (press and release)
     INPUT inputs[] = { inputDown, inputUp };
     SendInput(2, inputs, sizeof(INPUT));
-}
\ No newline at end of file
+}
+#endif
@@ -1,8 +1,10 @@
 #pragma once
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #define STRICT
 #include <windows.h>
+#endif
 #include <memory>
 #include <stdexcept>
 #include <cstdint>
@@ -56,47 +58,88 @@ struct Pixel {
     Pixel(uint8_t r, uint8_t g, uint8_t b) : red(r), green(g), blue(b) {}
 };
 
+// Pixels evenly spaced in a screenshot: a row slice when step is the pixel size, a column slice when it is the stride.
+// The scans test whole blocks of pixels without branching, which the compiler vectorises for packed rows
+struct PixelSpan {
+    const uint8_t* data = nullptr; // First pixel, blue first
+    uint32_t length = 0;
+    uint32_t step = 3; // Bytes from one pixel to the next
+
+    Pixel operator[](uint32_t i) const noexcept;
+    // Index of the first pixel from `from` on that is within range of color, length if there is none
+    uint32_t find(const Pixel& color, int range, uint32_t from = 0) const noexcept;
+    // Index of the first pixel from `from` on that is within range of neither colour, length if there is none
+    uint32_t find_unlike(const Pixel& a, const Pixel& b, int range, uint32_t from = 0) const noexcept;
+    uint32_t count(const Pixel& color, int range) const noexcept;
+};
+
+// A rectangle of a screenshot, rows stride bytes apart
+struct PixelRect {
+    const uint8_t* data = nullptr; // Top left pixel
+    Dimension dim;
+    uint32_t stride = 0;
+    uint32_t pixel_size = 3;
+
+    PixelSpan row(uint32_t y) const noexcept;
+    PixelSpan column(uint32_t x) const noexcept;
+    uint64_t count(const Pixel& color, int range) const noexcept;
+    bool contains(const Pixel& color, int range) const noexcept;
+};
+
+// Size of the whole desktop, spanning every monitor
+Dimension virtual_screen_size();
+
+// How a screenshot reaches memory. Windows always copies through GDI, X11 can share the image with the server.
+enum CaptureMode {
+    SHARED_CAPTURE, // MIT-SHM on X11, the server writes straight into the image the pixels are read from
+    COPY_CAPTURE    // Plain XGetImage on X11, a fresh image sent over the socket for every screenshot
+};
+
+// Captured pixels are blue, green, red in memory, pixel_size bytes apart and stride bytes per row on every platform
 class Screen {
 public:
-    // Iterator
-    struct PixelIterator {
-        const Screen* screen;
-        Position curr_pos;
-        Position end_pos;
-
-        PixelIterator(const Screen* s, Position sp, Position ep);
-
-        Pixel pixel() const noexcept;
-        Position position() const noexcept;
-        Position end() const noexcept;
-
-        PixelIterator& next() noexcept;
-        PixelIterator& jump_to(Position new_pos) noexcept;
-        PixelIterator& next_row() noexcept;
-    };
-    Screen(Position p = {0, 0}, 
-        Dimension d = { static_cast<uint32_t>(GetSystemMetrics(SM_CXVIRTUALSCREEN)), static_cast<uint32_t>(GetSystemMetrics(SM_CYVIRTUALSCREEN)) });
+    Screen(Position p = {0, 0}, Dimension d = virtual_screen_size(), CaptureMode mode = SHARED_CAPTURE);
     ~Screen();
+    Screen(const Screen&) = delete;
+    Screen& operator=(const Screen&) = delete;
     void take_screenshot();
     Position get_position() const { return pos; }
     Dimension get_dimension() const { return dim; }
+    uint32_t get_stride() const { return stride; }
+    uint32_t get_pixel_size() const { return pixel_size; }
+    const uint8_t* data() const { return pixels; }
     Pixel get_pixel(uint32_t x, uint32_t y) const noexcept;
+    bool contains_color(const Pixel& color, int range, Position start = Position{}, Dimension size = Dimension{}) const noexcept;
 
-    // Iteration
-    PixelIterator begin() const noexcept;
-    PixelIterator iterate_from(Position start_pos, Position end_pos = Position{}) const noexcept;
+    // Bulk access clamped to the screenshot, a zero length or size reaches its edge
+    PixelSpan row(uint32_t y, uint32_t x = 0, uint32_t length = 0) const noexcept;
+    PixelSpan column(uint32_t x, uint32_t y = 0, uint32_t length = 0) const noexcept;
+    PixelRect rect(Position start = Position{}, Dimension size = Dimension{}) const noexcept;
 private:
     Position pos;
     Dimension dim;
+    CaptureMode mode;
     uint32_t stride;  // Added for proper pixel addressing
+    uint32_t pixel_size = 3;
+    const uint8_t* pixels = nullptr; // Latest screenshot, owned by the platform resources below
+
+#ifdef _WIN32
     std::unique_ptr<uint8_t[]> bitmap_data;  // Raw bitmap data instead of vector of Pixels
-       
+
     // Screenshot resources and methods
     HDC screen_dc;
     HDC memory_dc;
     HBITMAP bitmap;
+#else
+    struct X11Capture; // Keeps Xlib's macros out of every file including this header
+    std::unique_ptr<X11Capture> x11;
+#endif
     bool init_resources();
     void clean_resources();
+
+    // Session hooks shared by the platform backends, see session.h
+    bool replay_screenshot();
+    void record_screenshot() const;
 };
 
 // Screen movement and actions
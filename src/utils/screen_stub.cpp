@@ -0,0 +1,44 @@
+// Screen backend for builds without a supported display system: capture and input throw, replays still work
+#include "screen.h"
+#include "session.h"
+#include "trace.h"
+
+struct Screen::X11Capture {};
+
+Dimension virtual_screen_size() {
+    return {};
+}
+
+bool Screen::init_resources() {
+    return false;
+}
+
+void Screen::clean_resources() {
+    pixels = nullptr;
+}
+
+Screen::Screen(Position p, Dimension d, CaptureMode m) : pos(p), dim(d), mode(m), stride(0) {}
+
+Screen::~Screen() = default;
+
+void Screen::take_screenshot() {
+    TRACE_SPAN("screen.take_screenshot");
+    if (replay_screenshot()) {
+        return;
+    }
+    throw ScreenshotException("Screen capture is unavailable, built without X11 and Xext");
+}
+
+void move_mouse(Position pos) {
+    if (session::intercept({ session::MOVE_RECORD, pos, LEFT_CLICK })) {
+        return;
+    }
+    throw std::runtime_error("Mouse input is unavailable, built without X11");
+}
+
+void mouse_click(MouseAction action) {
+    if (session::intercept({ session::CLICK_RECORD, {}, action })) {
+        return;
+    }
+    throw std::runtime_error("Mouse input is unavailable, built without X11");
+}
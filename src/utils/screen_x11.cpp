@@ -0,0 +1,283 @@
+// X11 backend for Screen: MIT-SHM capture straight into shared memory and XTest input injection
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <mutex>
+#include "screen.h"
+#include "session.h"
+#include "trace.h"
+
+// Xlib names its per-monitor struct Screen too, and defines macros like Status and None, so it comes last and renamed
+#define Screen XScreen
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#ifdef MSX_HAVE_XTEST
+#include <X11/extensions/XTest.h>
+#endif
+#undef Screen
+
+struct Screen::X11Capture {
+    Display* display = nullptr;
+    Window root = 0;
+    XImage* image = nullptr;      // Shared image refilled in place, or the latest XGetImage copy
+    XShmSegmentInfo shm = {};
+    bool attached = false;
+};
+
+namespace {
+    // The error handler is process wide, so traps on different threads take turns
+    std::mutex trap_mutex;
+    int trapped_error = 0;
+
+    int record_error(Display*, XErrorEvent* event) {
+        trapped_error = event->error_code;
+        return 0;
+    }
+
+    // Catches X errors raised by the requests made while it lives, such as BadMatch from a capture rectangle that
+    // leaves the root window, which Xlib's default handler would answer by exiting the process
+    class ErrorTrap {
+    public:
+        explicit ErrorTrap(Display* d) : display(d), lock(trap_mutex) {
+            XSync(display, False); // Errors of earlier requests are not ours
+            trapped_error = 0;
+            previous = XSetErrorHandler(record_error);
+        }
+        ~ErrorTrap() {
+            XSync(display, False);
+            XSetErrorHandler(previous);
+        }
+        ErrorTrap(const ErrorTrap&) = delete;
+        ErrorTrap& operator=(const ErrorTrap&) = delete;
+
+        // Error code of the first failed request so far, 0 if none
+        int error() {
+            XSync(display, False);
+            return trapped_error;
+        }
+
+    private:
+        Display* display;
+        std::lock_guard<std::mutex> lock;
+        int (*previous)(Display*, XErrorEvent*);
+    };
+
+    std::string error_text(Display* display, int code) {
+        char text[256] = {};
+        XGetErrorText(display, code, text, sizeof(text));
+        return text;
+    }
+
+    // Every capture is read as blue, green, red, padding; anything else would need converting per pixel
+    bool is_bgrx(const XImage* image) {
+        return image->bits_per_pixel == 32 && image->byte_order == LSBFirst
+            && image->red_mask == 0xff0000 && image->green_mask == 0x00ff00 && image->blue_mask == 0x0000ff;
+    }
+}
+
+Dimension virtual_screen_size() {
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        return {};
+    }
+    // The root window of the default screen spans every monitor under Xinerama and RandR
+    XScreen* screen = DefaultScreenOfDisplay(display);
+    Dimension dim(static_cast<uint32_t>(WidthOfScreen(screen)), static_cast<uint32_t>(HeightOfScreen(screen)));
+    XCloseDisplay(display);
+    return dim;
+}
+
+bool Screen::init_resources() {
+    if (x11) return true; // Already initialized
+
+    auto capture = std::make_unique<X11Capture>();
+    capture->display = XOpenDisplay(nullptr);
+    if (!capture->display) return false;
+    capture->root = DefaultRootWindow(capture->display);
+
+    if (mode == SHARED_CAPTURE) {
+        if (!XShmQueryExtension(capture->display)) {
+            XCloseDisplay(capture->display);
+            return false;
+        }
+        int screen = DefaultScreen(capture->display);
+        capture->image = XShmCreateImage(capture->display, DefaultVisual(capture->display, screen), DefaultDepth(capture->display, screen),
+            ZPixmap, nullptr, &capture->shm, dim.width, dim.height);
+        if (!capture->image) {
+            XCloseDisplay(capture->display);
+            return false;
+        }
+        x11 = std::move(capture);
+
+        // The segment is marked for removal as soon as both sides attach, or on any failure, so it cannot outlive the process
+        x11->shm.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(x11->image->bytes_per_line) * x11->image->height, IPC_CREAT | 0600);
+        if (x11->shm.shmid < 0) {
+            clean_resources();
+            return false;
+        }
+        x11->shm.shmaddr = x11->image->data = static_cast<char*>(shmat(x11->shm.shmid, nullptr, 0));
+        x11->shm.readOnly = False;
+        if (x11->shm.shmaddr == reinterpret_cast<char*>(-1)) {
+            shmctl(x11->shm.shmid, IPC_RMID, nullptr);
+            x11->shm.shmaddr = x11->image->data = nullptr;
+            clean_resources();
+            return false;
+        }
+        bool attached;
+        {
+            // Attaching fails with an error rather than a return value on a display without access to our memory
+            ErrorTrap trap(x11->display);
+            attached = XShmAttach(x11->display, &x11->shm) && trap.error() == 0;
+        }
+        if (!attached) {
+            shmctl(x11->shm.shmid, IPC_RMID, nullptr); // Freed once clean_resources detaches this side
+            clean_resources();
+            return false;
+        }
+        shmctl(x11->shm.shmid, IPC_RMID, nullptr);
+        x11->attached = true;
+
+        if (!is_bgrx(x11->image)) {
+            clean_resources();
+            return false;
+        }
+        stride = x11->image->bytes_per_line;
+        pixel_size = 4;
+        pixels = reinterpret_cast<const uint8_t*>(x11->image->data);
+    }
+    else {
+        x11 = std::move(capture);
+    }
+    return true;
+}
+
+void Screen::clean_resources() {
+    if (!x11) return;
+    if (x11->attached) {
+        XShmDetach(x11->display, &x11->shm);
+        XSync(x11->display, False);
+    }
+    if (x11->shm.shmaddr) {
+        shmdt(x11->shm.shmaddr);
+    }
+    if (x11->image) {
+        // The shared segment is not malloc'd, so Xlib must not free it with the image
+        if (mode == SHARED_CAPTURE) {
+            x11->image->data = nullptr;
+        }
+        XDestroyImage(x11->image);
+    }
+    XCloseDisplay(x11->display);
+    x11.reset();
+    pixels = nullptr;
+}
+
+Screen::Screen(Position p, Dimension d, CaptureMode m) : pos(p), dim(d), mode(m), stride(0) {
+    init_resources();
+}
+
+Screen::~Screen() {
+    clean_resources();
+}
+
+void Screen::take_screenshot() {
+    TRACE_SPAN("screen.take_screenshot");
+    if (replay_screenshot()) {
+        return;
+    }
+    if (dim.width == 0 || dim.height == 0) {
+        throw ScreenshotException("Invalid dimensions: width and height must be greater than 0");
+    }
+
+    if (!x11) {
+        throw ScreenshotException("Resources were not properly initialized");
+    }
+
+    if (mode == SHARED_CAPTURE) {
+        // The server writes the rectangle into the segment the pixels pointer already refers to
+        ErrorTrap trap(x11->display);
+        const bool copied = XShmGetImage(x11->display, x11->root, x11->image, pos.x, pos.y, AllPlanes);
+        if (const int error = trap.error()) {
+            throw ScreenshotException(("Failed to copy screen content: " + error_text(x11->display, error)).c_str());
+        }
+        if (!copied) {
+            throw ScreenshotException("Failed to copy screen content");
+        }
+        record_screenshot();
+        return;
+    }
+
+    XImage* image;
+    {
+        ErrorTrap trap(x11->display);
+        image = XGetImage(x11->display, x11->root, pos.x, pos.y, dim.width, dim.height, AllPlanes, ZPixmap);
+        if (const int error = trap.error()) {
+            if (image) {
+                XDestroyImage(image);
+            }
+            throw ScreenshotException(("Failed to copy screen content: " + error_text(x11->display, error)).c_str());
+        }
+    }
+    if (!image) {
+        throw ScreenshotException("Failed to copy screen content");
+    }
+    if (!is_bgrx(image)) {
+        XDestroyImage(image);
+        throw ScreenshotException("Unsupported screen pixel format");
+    }
+    if (x11->image) {
+        XDestroyImage(x11->image);
+    }
+    x11->image = image;
+    stride = image->bytes_per_line;
+    pixel_size = 4;
+    pixels = reinterpret_cast<const uint8_t*>(image->data);
+    record_screenshot();
+}
+
+#ifdef MSX_HAVE_XTEST
+// Input goes through one connection shared by every caller, opened on first use
+static Display* input_display() {
+    static Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        throw std::runtime_error("Failed to open X display for input");
+    }
+    return display;
+}
+
+void move_mouse(Position pos) {
+    if (session::intercept({ session::MOVE_RECORD, pos, LEFT_CLICK })) {
+        return;
+    }
+    Display* display = input_display();
+    XTestFakeMotionEvent(display, -1, pos.x, pos.y, CurrentTime);
+    XFlush(display);
+}
+
+void mouse_click(MouseAction action) {
+    if (session::intercept({ session::CLICK_RECORD, {}, action })) {
+        return;
+    }
+
+    // Press and release in one flush, like SendInput's pair on Windows
+    Display* display = input_display();
+    unsigned int button = action == LEFT_CLICK ? Button1 : Button3;
+    XTestFakeButtonEvent(display, button, True, CurrentTime);
+    XTestFakeButtonEvent(display, button, False, CurrentTime);
+    XFlush(display);
+}
+#else
+void move_mouse(Position pos) {
+    if (session::intercept({ session::MOVE_RECORD, pos, LEFT_CLICK })) {
+        return;
+    }
+    throw std::runtime_error("Built without XTest, mouse input is unavailable");
+}
+
+void mouse_click(MouseAction action) {
+    if (session::intercept({ session::CLICK_RECORD, {}, action })) {
+        return;
+    }
+    throw std::runtime_error("Built without XTest, mouse input is unavailable");
+}
+#endif
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "session.h"
+
+namespace {
+    constexpr char MAGIC[4] = { 'M', 'S', 'X', 'S' };
+    constexpr uint8_t VERSION = 1;
+    constexpr size_t MIN_ZERO_RUN = 8; // Shorter runs of zeros stay inside a literal run
+    constexpr uint64_t MAX_FRAME_PIXELS = 1 << 26; // 8192x8192, anything larger is a corrupt header
+
+    // Every zero and literal run pair but the last covers more than MIN_ZERO_RUN bytes and costs two varints of at most 10 bytes
+    uint64_t max_encoded_size(uint64_t frame_bytes) {
+        return frame_bytes + (frame_bytes / (MIN_ZERO_RUN + 1) + 2) * 20;
+    }
+
+    std::unique_ptr<session::Recorder> recorder;
+    session::Player* player = nullptr;
+
+    void write_varint(std::ostream& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.put(static_cast<char>(value));
+    }
+
+    void append_varint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t read_varint(std::istream& in) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const int byte = in.get();
+            if (byte == std::char_traits<char>::eof()) {
+                throw std::runtime_error("Session file ends inside a record");
+            }
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Malformed varint in session file");
+    }
+
+    uint64_t take_varint(const std::vector<uint8_t>& in, size_t& offset) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && offset < in.size(); shift += 7) {
+            const uint8_t byte = in[offset++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Malformed frame in session file");
+    }
+
+    // Zero runs and literal runs, alternating, starting with a zero run that may be empty
+    void encode_delta(const std::vector<uint8_t>& delta, std::vector<uint8_t>& out) {
+        out.clear();
+        size_t i = 0;
+        while (i < delta.size()) {
+            const size_t zeros_start = i;
+            while (i < delta.size() && delta[i] == 0) {
+                i++;
+            }
+            append_varint(out, i - zeros_start);
+
+            const size_t literal_start = i;
+            size_t zeros = 0;
+            while (i < delta.size() && zeros < MIN_ZERO_RUN) {
+                zeros = delta[i] == 0 ? zeros + 1 : 0;
+                i++;
+            }
+            if (zeros == MIN_ZERO_RUN) {
+                i -= zeros;
+            }
+            append_varint(out, i - literal_start);
+            out.insert(out.end(), delta.begin() + literal_start, delta.begin() + i);
+        }
+    }
+
+    // XORs the decoded delta into pixels, which hold the previous frame or zeros
+    void decode_delta(const std::vector<uint8_t>& in, std::vector<uint8_t>& pixels) {
+        size_t offset = 0;
+        size_t i = 0;
+        while (i < pixels.size() && offset < in.size()) {
+            i += take_varint(in, offset);
+            const uint64_t literals = take_varint(in, offset);
+            if (i + literals > pixels.size() || offset + literals > in.size()) {
+                throw std::runtime_error("Malformed frame in session file");
+            }
+            for (uint64_t k = 0; k < literals; k++) {
+                pixels[i++] ^= in[offset++];
+            }
+        }
+    }
+
+    std::string describe(const session::Input& input) {
+        if (input.type == session::CLICK_RECORD) {
+            return input.action == LEFT_CLICK ? "left click" : "right click";
+        }
+        return "move to (" + std::to_string(input.pos.x) + ", " + std::to_string(input.pos.y) + ")";
+    }
+
+    bool same_input(const session::Input& a, const session::Input& b) {
+        if (a.type != b.type) {
+            return false;
+        }
+        return a.type == session::CLICK_RECORD ? a.action == b.action : a.pos == b.pos;
+    }
+}
+
+// Recorder
+
+session::Recorder::Recorder(const std::string& path) : out(path, std::ios::binary), last_record(std::chrono::steady_clock::now()) {
+    if (!out) {
+        throw std::runtime_error("Could not open session file: " + path);
+    }
+    out.write(MAGIC, sizeof(MAGIC));
+    out.put(static_cast<char>(VERSION));
+}
+
+void session::Recorder::header(RecordType type) {
+    const auto now = std::chrono::steady_clock::now();
+    out.put(static_cast<char>(type));
+    write_varint(out, std::chrono::duration_cast<std::chrono::microseconds>(now - last_record).count());
+    last_record = now;
+}
+
+void session::Recorder::frame(Position pos, Dimension dim, const uint8_t* pixels, uint32_t stride, uint32_t pixel_size) {
+    const size_t row_bytes = static_cast<size_t>(dim.width) * 3;
+    current.resize(row_bytes * dim.height);
+    for (uint32_t y = 0; y < dim.height; y++) {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        uint8_t* packed = current.data() + y * row_bytes;
+        for (uint32_t x = 0; x < dim.width; x++) {
+            packed[x * 3] = row[x * pixel_size];
+            packed[x * 3 + 1] = row[x * pixel_size + 1];
+            packed[x * 3 + 2] = row[x * pixel_size + 2];
+        }
+    }
+
+    // XOR in place against the previous frame, then swap so previous holds the plain pixels again
+    const bool delta = pos == previous_pos && dim.width == previous_dim.width && dim.height == previous_dim.height;
+    if (delta) {
+        for (size_t i = 0; i < current.size(); i++) {
+            previous[i] ^= current[i];
+        }
+        encode_delta(previous, encoded);
+    }
+    else {
+        encode_delta(current, encoded);
+    }
+    std::swap(previous, current);
+    previous_pos = pos;
+    previous_dim = dim;
+
+    header(FRAME_RECORD);
+    write_varint(out, pos.x);
+    write_varint(out, pos.y);
+    write_varint(out, dim.width);
+    write_varint(out, dim.height);
+    write_varint(out, encoded.size());
+    out.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    out.flush();
+}
+
+void session::Recorder::input(const Input& input) {
+    header(input.type);
+    if (input.type == CLICK_RECORD) {
+        out.put(static_cast<char>(input.action));
+    }
+    else {
+        write_varint(out, input.pos.x);
+        write_varint(out, input.pos.y);
+    }
+}
+
+// Player
+
+session::Player::Player(const std::string& path, bool r) : in(path, std::ios::binary), recorded_speed(r),
+    start(std::chrono::steady_clock::now()) {
+    if (!in) {
+        throw std::runtime_error("Could not open session file: " + path);
+    }
+    char magic[sizeof(MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    if (!in || !std::equal(magic, magic + sizeof(magic), MAGIC) || in.get() != VERSION) {
+        throw std::runtime_error("Not a version " + std::to_string(VERSION) + " session file: " + path);
+    }
+}
+
+bool session::Player::read_record() {
+    if (peeked) {
+        return true;
+    }
+    const int type = in.get();
+    if (type == std::char_traits<char>::eof()) {
+        ended = true;
+        return false;
+    }
+    recorded_time += std::chrono::microseconds(read_varint(in));
+    peek_type = static_cast<RecordType>(type);
+    switch (peek_type) {
+    case FRAME_RECORD: {
+        peek_pos.x = static_cast<uint32_t>(read_varint(in));
+        peek_pos.y = static_cast<uint32_t>(read_varint(in));
+        peek_dim.width = static_cast<uint32_t>(read_varint(in));
+        peek_dim.height = static_cast<uint32_t>(read_varint(in));
+        const uint64_t pixels = static_cast<uint64_t>(peek_dim.width) * peek_dim.height;
+        const uint64_t size = read_varint(in);
+        if (pixels > MAX_FRAME_PIXELS || size > max_encoded_size(pixels * 3)) {
+            throw std::runtime_error("Corrupt frame size in session file");
+        }
+        encoded.resize(size);
+        in.read(reinterpret_cast<char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        break;
+    }
+    case MOVE_RECORD:
+        peek_input = Input{ MOVE_RECORD, {}, LEFT_CLICK };
+        peek_input.pos.x = static_cast<uint32_t>(read_varint(in));
+        peek_input.pos.y = static_cast<uint32_t>(read_varint(in));
+        break;
+    case CLICK_RECORD:
+        peek_input = Input{ CLICK_RECORD, {}, LEFT_CLICK };
+        peek_input.action = static_cast<MouseAction>(in.get());
+        break;
+    default:
+        throw std::runtime_error("Unknown record type in session file: " + std::to_string(type));
+    }
+    if (!in) {
+        throw std::runtime_error("Session file ends inside a record");
+    }
+    peeked = true;
+    return true;
+}
+
+void session::Player::diverge(const std::string& description) {
+    if (stats.first_divergence.empty()) {
+        stats.first_divergence = "input " + std::to_string(inputs_seen) + " after frame " + std::to_string(stats.frames) + ": " + description;
+    }
+}
+
+const session::Frame& session::Player::next_frame() {
+    // Recorded inputs before the frame that the replay never sent
+    while (read_record() && peek_type != FRAME_RECORD) {
+        stats.missing++;
+        diverge("expected " + describe(peek_input) + ", got a screenshot");
+        peeked = false;
+    }
+    if (ended) {
+        throw SessionEnded("Session has no more frames");
+    }
+    peeked = false;
+
+    if (recorded_speed) {
+        std::this_thread::sleep_until(start + recorded_time);
+    }
+
+    const auto decode_start = std::chrono::steady_clock::now();
+    const bool delta = peek_pos == frame.pos && peek_dim.width == frame.dim.width && peek_dim.height == frame.dim.height;
+    if (!delta) {
+        frame.pos = peek_pos;
+        frame.dim = peek_dim;
+        frame.pixels.assign(static_cast<size_t>(peek_dim.width) * peek_dim.height * 3, 0);
+    }
+    decode_delta(encoded, frame.pixels);
+    frame.time = recorded_time;
+    stats.decode_time += std::chrono::steady_clock::now() - decode_start;
+    stats.frames++;
+    return frame;
+}
+
+void session::Player::input(const Input& input) {
+    inputs_seen++;
+    if (!read_record() || peek_type == FRAME_RECORD) {
+        stats.extra++;
+        diverge("expected a screenshot, got " + describe(input));
+        return;
+    }
+    peeked = false;
+    if (same_input(input, peek_input)) {
+        stats.matched++;
+    }
+    else {
+        stats.mismatched++;
+        diverge("expected " + describe(peek_input) + ", got " + describe(input));
+    }
+}
+
+// Active session
+
+void session::start_recording(const std::string& path) {
+    recorder = std::make_unique<Recorder>(path);
+}
+
+void session::stop_recording() {
+    recorder.reset();
+}
+
+session::Recorder* session::active_recorder() {
+    return recorder.get();
+}
+
+void session::set_player(Player* p) {
+    player = p;
+}
+
+session::Player* session::active_player() {
+    return player;
+}
+
+bool session::intercept(const Input& input) {
+    if (recorder) {
+        recorder->input(input);
+    }
+    if (player) {
+        player->input(input);
+        return true;
+    }
+    return false;
+}
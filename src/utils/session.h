@@ -0,0 +1,114 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "screen.h"
+
+// Recording of every screenshot and mouse input of a run, and replay of them through the same Screen and mouse calls.
+//
+// A session file starts with the magic "MSXS" and a version byte, followed by records written as they happen:
+//   type (1 byte), microseconds since the previous record (varint), then per type
+//   FRAME_RECORD  x, y, width, height, encoded size (varints) and the encoded frame
+//   MOVE_RECORD   x, y (varints)
+//   CLICK_RECORD  mouse action (1 byte)
+// Frames are packed blue, green, red rows. When a frame covers the same rectangle as the one before it, it is stored as
+// the XOR with that frame, so unchanged pixels become zeros. The encoding alternates varint counts of zero bytes and of
+// literal bytes, with the literal bytes following their count.
+namespace session {
+    enum RecordType : uint8_t {
+        FRAME_RECORD = 1,
+        MOVE_RECORD = 2,
+        CLICK_RECORD = 3
+    };
+
+    struct Frame {
+        std::chrono::microseconds time{ 0 }; // Since the start of the recording
+        Position pos;
+        Dimension dim;
+        std::vector<uint8_t> pixels; // Packed rows, 3 bytes per pixel
+    };
+
+    struct Input {
+        RecordType type = MOVE_RECORD;
+        Position pos;                    // Moves only
+        MouseAction action = LEFT_CLICK; // Clicks only
+    };
+
+    class SessionEnded : public std::runtime_error {
+    public:
+        explicit SessionEnded(const char* message) : std::runtime_error(message) {}
+    };
+
+    // Streams a session to disk, flushing after every frame so a crashed run still leaves a usable file
+    class Recorder {
+    public:
+        explicit Recorder(const std::string& path);
+        void frame(Position pos, Dimension dim, const uint8_t* pixels, uint32_t stride, uint32_t pixel_size);
+        void input(const Input& input);
+
+    private:
+        std::ofstream out;
+        std::chrono::steady_clock::time_point last_record;
+        Position previous_pos;
+        Dimension previous_dim;
+        std::vector<uint8_t> previous; // Last frame, packed
+        std::vector<uint8_t> current;
+        std::vector<uint8_t> encoded;
+        void header(RecordType type);
+    };
+
+    // How the replay compared with the recorded run
+    struct ReplayStats {
+        int frames = 0;
+        int matched = 0;    // Inputs equal to the recorded input at the same point
+        int mismatched = 0; // Inputs that differ from it
+        int missing = 0;    // Recorded inputs the replay never sent before the next frame
+        int extra = 0;      // Inputs sent where the recording moved on to a frame
+        std::string first_divergence;
+        std::chrono::nanoseconds decode_time{ 0 };
+    };
+
+    // Reads a session back in order. Screenshots take the next frame and inputs are checked against the recorded ones,
+    // at the recorded pace or as fast as the frames decode
+    class Player {
+    public:
+        Player(const std::string& path, bool recorded_speed);
+        const Frame& next_frame(); // Throws SessionEnded after the last frame
+        void input(const Input& input);
+        const ReplayStats& get_stats() const { return stats; }
+
+    private:
+        std::ifstream in;
+        bool recorded_speed;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::microseconds recorded_time{ 0 };
+        ReplayStats stats;
+        Frame frame;
+        std::vector<uint8_t> encoded;
+        int inputs_seen = 0;
+
+        // One record of lookahead, so an input can be compared without consuming a frame
+        bool peeked = false;
+        bool ended = false;
+        RecordType peek_type = FRAME_RECORD;
+        Input peek_input;
+        Position peek_pos;
+        Dimension peek_dim;
+        bool read_record();
+        void diverge(const std::string& description);
+    };
+
+    // The recorder or player the Screen and mouse functions currently go through, null when neither is running
+    void start_recording(const std::string& path);
+    void stop_recording();
+    Recorder* active_recorder();
+    void set_player(Player* player);
+    Player* active_player();
+
+    // Called by the mouse functions before they send anything. Records the input, and returns true when a replay
+    // takes it instead of the real mouse
+    bool intercept(const Input& input);
+}
@@ -3,6 +3,9 @@
 #include <sstream>
 #include <iomanip>
 
+constexpr int8_t DRAWN_NONE = INT8_MIN;
+constexpr int BOARD_TOP = 4;  // Screen row of the first board row
+constexpr int BOARD_LEFT = 5; // Screen column of the first tile character
 
 void BoardDisplay::clear_screen() {
 	std::cout << "\033[2J\033[1;1H";
@@ -12,43 +15,25 @@ void BoardDisplay::move_cursor(int row, int col) {
 	std::cout << "\033[" << row << ";" << col << "H";
 }
 
-std::string BoardDisplay::board_to_string() const {
-    std::ostringstream oss;
-    oss << "Minesweeper Solver X:\n";
-    const std::vector<Tile>& tiles = board->get_all_tiles();
-
-    // Add column numbers
-    oss << "   "; // Padding for row numbers
-    for (int x = 0; x < board->get_width(); x++) {
-        oss << std::setw(2) << x << " ";
-    }
-    oss << "\n";
-
-    // Add separator line
-    oss << "   " << std::string(board->get_width() * 3, '-') << "\n";
-
-    for (int y = 0; y < board->get_height(); y++) {
-        oss << std::setw(2) << y << "|"; // Row numbers
-        for (int x = 0; x < board->get_width(); x++) {
-            const Tile& tile = tiles[y * board->get_width() + x];
-            oss << " ";
-            if (tile.value == UNDISCOVERED) {
-                oss << "-";
-            }
-            else if (tile.value == MINE) {
-                oss << "X";
-            }
-            else if (tile.value == UNKNOWN) {
-                oss << "?";
-            }
-            else {
-                oss << tile.value;
-            }
-            oss << " ";
-        }
-        oss << "\n";
-    }
-    return oss.str();
+void BoardDisplay::append_cursor(int row, int col) {
+	frame += "\033[";
+	frame += std::to_string(row);
+	frame += ';';
+	frame += std::to_string(col);
+	frame += 'H';
+}
+
+static char tile_char(int value) {
+	if (value == UNDISCOVERED) {
+		return '-';
+	}
+	else if (value == MINE) {
+		return 'X';
+	}
+	else if (value == UNKNOWN) {
+		return '?';
+	}
+	return static_cast<char>('0' + value);
 }
 
 BoardDisplay::BoardDisplay(std::shared_ptr<Board> b) : board(b) {
@@ -56,33 +41,142 @@ BoardDisplay::BoardDisplay(std::shared_ptr<Board> b) : board(b) {
 	terminal_height = board_height + max_output_lines + 3;
 	clear_screen();
 
-	move_cursor(board_height + 2, 1);
+	// Everything but the tiles is drawn once
+	std::ostringstream oss;
+	oss << "Minesweeper Solver X:\n";
+	oss << "   "; // Padding for row numbers
+	for (int x = 0; x < board->get_width(); x++) {
+		oss << std::setw(2) << x << " ";
+	}
+	oss << "\n";
+	oss << "   " << std::string(board->get_width() * 3, '-') << "\n";
+	for (int y = 0; y < board->get_height(); y++) {
+		oss << std::setw(2) << y << "|\n";
+	}
+	std::cout << oss.str();
+
+	move_cursor(static_cast<int>(board_height) + 2, 1);
 	std::cout << std::string(board->get_width(), '-') << std::endl;
 
+	const size_t size = board->get_all_tiles().size();
+	pending.assign(size, static_cast<int8_t>(UNDISCOVERED));
+	snapshot.assign(size, static_cast<int8_t>(UNDISCOVERED));
+	drawn.assign(size, DRAWN_NONE);
 	output_buffer.reserve(max_output_lines);
+	renderer = std::thread(&BoardDisplay::render_loop, this);
 }
 
 BoardDisplay::~BoardDisplay() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	renderer.join(); // Draws the last state first
+
     // Move cursor to the end of all output before destroying
-    move_cursor(terminal_height + 1, 1);
+    move_cursor(static_cast<int>(terminal_height) + 1, 1);
     std::cout << std::flush;
 }
 
 void BoardDisplay::update_board() {
-	move_cursor(1, 1);
-	std::cout << board_to_string() << std::flush;
+	const std::vector<Tile>& tiles = board->get_all_tiles();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < tiles.size(); i++) {
+			pending[i] = static_cast<int8_t>(tiles[i].value);
+		}
+		board_dirty = true;
+	}
+	wake.notify_one();
 }
 
-void BoardDisplay::print(const std::string& message) {
-	output_buffer.push_back(message);
-	if (output_buffer.size() > max_output_lines) {
-		output_buffer.erase(output_buffer.begin());
+void BoardDisplay::print(std::string_view message) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (output_buffer.size() < max_output_lines) {
+			output_buffer.emplace_back(message);
+		}
+		else {
+			output_buffer[output_start].assign(message); // Reuses the oldest line's storage
+			output_start = (output_start + 1) % max_output_lines;
+		}
+		log_dirty = true;
 	}
+	wake.notify_one();
+}
+
+void BoardDisplay::render_loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [&]() { return stopping || board_dirty || log_dirty; });
+		const bool stop = stopping;
+		const bool draw_board = board_dirty;
+		const bool draw_output = log_dirty;
+		if (draw_board) {
+			std::swap(pending, snapshot); // update_board rewrites every value, so the stale swap is harmless
+		}
+		if (draw_output) {
+			log_lines.resize(output_buffer.size());
+			for (size_t i = 0; i < output_buffer.size(); i++) {
+				log_lines[i].assign(output_buffer[(output_start + i) % output_buffer.size()]);
+			}
+		}
+		board_dirty = false;
+		log_dirty = false;
+		lock.unlock();
+
+		const auto frame_start = std::chrono::steady_clock::now();
+		frame.clear();
+		if (draw_board) {
+			draw_cells();
+		}
+		if (draw_output) {
+			draw_log();
+		}
+		if (!frame.empty()) {
+			std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+			std::cout.flush();
+		}
+		if (stop) {
+			return;
+		}
+
+		// Changes in the meantime are merged into the next frame, stopping draws the last one right away
+		lock.lock();
+		wake.wait_until(lock, frame_start + FRAME_INTERVAL, [&]() { return stopping; });
+	}
+}
 
-	move_cursor(board_height + 3, 1);
-	std::cout << "\033[J";
-	for (const std::string& line : output_buffer) {
-		std::cout << line << "\n";
+// Only tiles whose value changed, runs of neighbouring tiles share one cursor move
+void BoardDisplay::draw_cells() {
+	const int width = board->get_width();
+	const int height = board->get_height();
+	for (int y = 0; y < height; y++) {
+		int next_x = -1; // Tile the cursor is in front of
+		for (int x = 0; x < width; x++) {
+			const size_t i = static_cast<size_t>(y) * width + x;
+			if (snapshot[i] == drawn[i]) {
+				continue;
+			}
+			if (x == next_x) {
+				frame += "  ";
+			}
+			else {
+				append_cursor(BOARD_TOP + y, BOARD_LEFT + 3 * x);
+			}
+			frame += tile_char(snapshot[i]);
+			drawn[i] = snapshot[i];
+			next_x = x + 1;
+		}
 	}
-	std::cout << std::flush;
-}
\ No newline at end of file
+}
+
+void BoardDisplay::draw_log() {
+	append_cursor(static_cast<int>(board_height) + 3, 1);
+	frame += "\033[J";
+	for (const std::string& line : log_lines) {
+		frame += line;
+		frame += '\n';
+	}
+}
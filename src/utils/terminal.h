@@ -1,24 +1,52 @@
 #pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "core/board.h"
 
-
+// Live view of a board and the latest log lines. The solver thread only copies the tile values and log lines
+// under a lock, a background thread redraws the cells that changed since its last frame at a capped frame rate.
 class BoardDisplay {
 private:
 	std::shared_ptr<Board> board;
 	size_t board_height;
 	size_t terminal_height;
-	std::vector<std::string> output_buffer;
 	const size_t max_output_lines = 25;
+	static constexpr std::chrono::milliseconds FRAME_INTERVAL{ 33 };
+
+	// Shared with the render thread
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<int8_t> pending;            // Latest tile values from update_board
+	std::vector<std::string> output_buffer; // Ring of log lines, oldest at output_start
+	size_t output_start = 0;
+	bool board_dirty = false;
+	bool log_dirty = false;
+	bool stopping = false;
+
+	// Owned by the render thread
+	std::vector<int8_t> snapshot;
+	std::vector<int8_t> drawn; // Tile values on screen, DRAWN_NONE before the first frame
+	std::vector<std::string> log_lines;
+	std::string frame;
+	std::thread renderer;
 
 	void clear_screen();
 	void move_cursor(int row, int col);
-	std::string board_to_string() const;
+	void append_cursor(int row, int col);
+	void render_loop();
+	void draw_cells();
+	void draw_log();
 
 public:
 	BoardDisplay(std::shared_ptr<Board> b);
 	~BoardDisplay();
 	void update_board();
-	void print(const std::string& message);
-};
\ No newline at end of file
+	void print(std::string_view message);
+};
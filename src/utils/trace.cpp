@@ -0,0 +1,78 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "trace.h"
+
+namespace {
+    static_assert((trace::BUFFER_CAPACITY & (trace::BUFFER_CAPACITY - 1)) == 0, "Buffer capacity must be a power of two");
+
+    // Single writer ring, only the owning thread stores events
+    struct ThreadBuffer {
+        uint32_t thread_id = 0;
+        std::unique_ptr<trace::Event[]> events = std::make_unique<trace::Event[]>(trace::BUFFER_CAPACITY);
+        std::atomic<uint64_t> written{ 0 };
+    };
+
+    // Buffers outlive their threads so they can still be dumped at the end of the run
+    std::mutex registry_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+    ThreadBuffer& local_buffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+            std::shared_ptr<ThreadBuffer> created = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            created->thread_id = static_cast<uint32_t>(registry.size() + 1);
+            registry.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    void write_escaped(std::ofstream& out, const char* text) {
+        for (; *text != '\0'; text++) {
+            if (*text == '"' || *text == '\\') out << '\\';
+            out << *text;
+        }
+    }
+}
+
+int64_t trace::now_ns() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void trace::record(const char* name, int64_t start_ns, int64_t duration_ns) {
+    ThreadBuffer& buffer = local_buffer();
+    const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[index & (BUFFER_CAPACITY - 1)] = Event{ name, start_ns, duration_ns };
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void trace::write_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not open trace file: " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : registry) {
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t begin = written > BUFFER_CAPACITY ? written - BUFFER_CAPACITY : 0;
+        for (uint64_t i = begin; i < written; i++) {
+            const Event& event = buffer->events[i & (BUFFER_CAPACITY - 1)];
+            out << (first ? "\n" : ",\n") << "{\"name\":\"";
+            write_escaped(out, event.name);
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+                << ",\"ts\":" << event.start_ns / 1000 << '.' << (event.start_ns % 1000) / 100
+                << ",\"dur\":" << event.duration_ns / 1000 << '.' << (event.duration_ns % 1000) / 100 << '}';
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Timeline tracing of solver and game spans, written as Chrome trace_event JSON (open in Perfetto or chrome://tracing).
+// Spans are only recorded when built with -DMSX_TRACE=ON; otherwise TRACE_SPAN expands to nothing.
+namespace trace {
+    // Events kept per thread, older events are overwritten once the ring is full
+    constexpr size_t BUFFER_CAPACITY = 1 << 16;
+
+    struct Event {
+        const char* name; // Must be a string literal, only the pointer is stored
+        int64_t start_ns;
+        int64_t duration_ns;
+    };
+
+#ifdef MSX_TRACE
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    // Nanoseconds since the first call in this process
+    int64_t now_ns();
+
+    // Appends to the calling thread's ring buffer without locking
+    void record(const char* name, int64_t start_ns, int64_t duration_ns);
+
+    // Writes every thread's buffered events, call once the traced threads are done
+    void write_chrome_trace(const std::string& path);
+
+    class Span {
+    public:
+        explicit Span(const char* n) : name(n), start(now_ns()) {}
+        ~Span() { record(name, start, now_ns() - start); }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        int64_t start;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef MSX_TRACE
+#define TRACE_SPAN(name) trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif